@@ -1,97 +1,179 @@
 #pragma once
 
 #include <stdexcept>
-#include "SelfBalancedBT.h"
+#include "FingerBT.h"
+#include "RotationCounter.h"
+#include "Augment.h"
 
 namespace sine {
 namespace tree {
 
-template<class T>
-class AVLTree : public SelfBalancedBT<T> {
+/**
+ * AVL 
+ * A Ϊڵչ Augment.hR Ϊת RotationCounter.h
+ */
+template<class T, class A = NoAugment, class R = NoRotationCount>
+class AVLTree : public FingerBT<T> {
 
 public:
 
+    using FingerBT<T>::insert;
+
     virtual bool insert(const_ref);
     virtual bool remove(const_ref);
 
     virtual bool checkBalance() const;
 
+    typename A::value_type aggregate(const_ref lo, const_ref hi) const;  // [lo, hi] ڵľۺֵ
+
+    void compact();  // ѽڵ㰴 van Emde Boas ˳ᵽһڴУ֮Կ޸
+    MemoryStats memoryStats() const;
+
+    static unsigned long long rotationCount();  // ͬһ͵ۼƵתR Ϊ NoRotationCount ʱΪ 0
+    static void resetRotationCount();
+
+protected:
+
+    virtual Bnode_ptr insertSubtree(const_ref, Bnode_ptr_ref, int &sign);
+    virtual bool propagateInsert(Bnode_ptr_ref, int i, int &sign);
+    virtual void afterInsert();
+
 private:
 
     class Node;
     typedef Node * node_ptr;
 
-    class Node : public BinaryNode {
+    class Node : public A::template Node<BinaryNode> {
     public:
         int BF;
         Node();
         Node(const_ref);
         virtual Bnode_ptr clone();
+        bool live() const;
     };
 
     static Bnode_ptr insertToTree(const_ref, Bnode_ptr_ref, int &sign);
     static Bnode_ptr removeFromTree(const_ref, Bnode_ptr_ref, int &sign);
+    static void fixInsert(Bnode_ptr_ref, int, int sign2, int &sign);  // ʱ޸
 
     static void rotate(Bnode_ptr_ref, bool right);
+    static void pull(Bnode_ptr);  // ¼ڵչ
     static void fixUnbalance(Bnode_ptr_ref, int, int &sign);  // ɾʱ޸
     static Bnode_ptr pickMaxAndFix(Bnode_ptr_ref, int &sign);
 
     static int debugTest(node_ptr, bool fail);
     static int testAndGetHeight(node_ptr);
 
+    typedef typename R::template Counter<AVLTree<T, A, R> > Rotations;
+
 };
 
-template<class T>
-bool AVLTree<T>::insert(const_ref t) {
+template<class T, class A, class R>
+bool AVLTree<T, A, R>::insert(const_ref t) {
+    dropFinger();
     if (root == NULL) {
         root = new Node(t);
+        pull(root);
         return true;
     }
     int unused = 0;
     return insertToTree(t, root, unused) != NULL;
 }
 
-template<class T>
-bool AVLTree<T>::remove(const_ref t) {
+template<class T, class A, class R>
+bool AVLTree<T, A, R>::remove(const_ref t) {
+    dropFinger();
     if (root == NULL)
         return false;
     int unused = 0;
     Bnode_ptr del = removeFromTree(t, root, unused);
-    delete del;
+    freeNode(del);
     return del != NULL;
 }
 
-template<class T>
-bool AVLTree<T>::checkBalance() const {
+template<class T, class A, class R>
+bool AVLTree<T, A, R>::checkBalance() const {
     return testAndGetHeight(dynamic_cast<node_ptr>(root)) >= 0;
 }
 
-template<class T>
-AVLTree<T>::Node::Node()
+template<class T, class A, class R>
+typename A::value_type AVLTree<T, A, R>::aggregate(const_ref lo, const_ref hi) const {
+    return A::query(static_cast<const Node *>(root), &lo, &hi);
+}
+
+template<class T, class A, class R>
+void AVLTree<T, A, R>::compact() {
+    dropFinger();
+    compactAs<Node>();
+}
+
+template<class T, class A, class R>
+MemoryStats AVLTree<T, A, R>::memoryStats() const {
+    return statsAs<Node>();
+}
+
+template<class T, class A, class R>
+unsigned long long AVLTree<T, A, R>::rotationCount() {
+    return Rotations::count();
+}
+
+template<class T, class A, class R>
+void AVLTree<T, A, R>::resetRotationCount() {
+    Rotations::reset();
+}
+
+template<class T, class A, class R>
+typename AVLTree<T, A, R>::Bnode_ptr AVLTree<T, A, R>::insertSubtree
+(const_ref t, Bnode_ptr_ref _r, int &sign) {
+    sign = 0;
+    return insertToTree(t, _r, sign);
+}
+
+template<class T, class A, class R>
+bool AVLTree<T, A, R>::propagateInsert(Bnode_ptr_ref _r, int i, int &sign) {
+    int sign2 = sign;
+    sign = 0;
+    fixInsert(_r, i, sign2, sign);
+    pull(_r);
+    return sign != 0 || A::enabled;  // չʱһֱµ
+}
+
+template<class T, class A, class R>
+void AVLTree<T, A, R>::afterInsert() {
+}
+
+template<class T, class A, class R>
+AVLTree<T, A, R>::Node::Node()
     : BF(0) {
 }
 
-template<class T>
-AVLTree<T>::Node::Node(const_ref v)
-    : BinaryNode(v), BF(0) {
+template<class T, class A, class R>
+AVLTree<T, A, R>::Node::Node(const_ref v)
+    : A::template Node<BinaryNode>(v), BF(0) {
 }
 
-template<class T>
-typename AVLTree<T>::Bnode_ptr AVLTree<T>::Node::clone() {
+template<class T, class A, class R>
+typename AVLTree<T, A, R>::Bnode_ptr AVLTree<T, A, R>::Node::clone() {
     node_ptr rtn = new Node(v);
     rtn->BF = BF;
     if (child[0] != NULL)
         rtn->child[0] = child[0]->clone();
     if (child[1] != NULL)
         rtn->child[1] = child[1]->clone();
+    pull(rtn);
     return rtn;
 }
 
+template<class T, class A, class R>
+bool AVLTree<T, A, R>::Node::live() const {
+    return true;
+}
+
 /**
  * ܿսڵ
  */
-template<class T>
-typename AVLTree<T>::Bnode_ptr AVLTree<T>::insertToTree
+template<class T, class A, class R>
+typename AVLTree<T, A, R>::Bnode_ptr AVLTree<T, A, R>::insertToTree
 (const_ref v, Bnode_ptr_ref _r, int &sign) {
     if (v == _r->v)
         return NULL;
@@ -104,14 +186,29 @@ typename AVLTree<T>::Bnode_ptr AVLTree<T>::insertToTree
             sign = 1;
         r->BF += a;
         _c = new Node(v);
+        pull(_c);
+        pull(_r);
         return _c;
     }
     int sign2 = 0;
     Bnode_ptr p = insertToTree(v, _c, sign2);
     if (p == NULL)
         return NULL;
+    fixInsert(_r, i, sign2, sign);
+    pull(_r);
+    return p;
+}
+
+/**
+ * ӽڵ i ĸ߶ʱsign2 Ϊ 1ƽӣҪʱת
+ */
+template<class T, class A, class R>
+void AVLTree<T, A, R>::fixInsert(Bnode_ptr_ref _r, int i, int sign2, int &sign) {
     if (sign2 == 0)
-        return p;
+        return;
+    int a = i == 0 ? 1 : -1;
+    node_ptr r = dynamic_cast<node_ptr>(_r);
+    Bnode_ptr_ref _c = _r->child[i];
     if (r->BF == 0)
         sign = 1;
     r->BF += a;
@@ -120,14 +217,13 @@ typename AVLTree<T>::Bnode_ptr AVLTree<T>::insertToTree
             rotate(_c, i == 1);
         rotate(_r, i == 0);
     }
-    return p;
 }
 
 /**
 * ܿսڵ
 */
-template<class T>
-typename AVLTree<T>::Bnode_ptr AVLTree<T>::removeFromTree
+template<class T, class A, class R>
+typename AVLTree<T, A, R>::Bnode_ptr AVLTree<T, A, R>::removeFromTree
 (const_ref v, Bnode_ptr_ref _r, int &sign) {
     Bnode_ptr rtn = _r;
     int sign2 = 0;
@@ -149,6 +245,7 @@ typename AVLTree<T>::Bnode_ptr AVLTree<T>::removeFromTree
             _r = NULL;
             sign = 1;
         }
+        pull(_r);
         rtn->child[0] = NULL;
         rtn->child[1] = NULL;
         return rtn;
@@ -162,6 +259,7 @@ typename AVLTree<T>::Bnode_ptr AVLTree<T>::removeFromTree
         return false;
     if (sign2 == 1)
         fixUnbalance(_r, i, sign);
+    pull(_r);
     return rtn;
 }
 
@@ -190,8 +288,8 @@ typename AVLTree<T>::Bnode_ptr AVLTree<T>::removeFromTree
  * ۺϣ
  * m2 - m = Min{0, n2} - 1, n2 - n = Min{0, -m} - 1
  */
-template<class T>
-void AVLTree<T>::rotate(Bnode_ptr_ref _r, bool right) {
+template<class T, class A, class R>
+void AVLTree<T, A, R>::rotate(Bnode_ptr_ref _r, bool right) {
     int i = right ? 1 : 0;
     int a = right ? -1 : 1;
     Bnode_ptr _c = _r->child[1 - i];
@@ -202,10 +300,19 @@ void AVLTree<T>::rotate(Bnode_ptr_ref _r, bool right) {
         (dynamic_cast<node_ptr>(_r)->BF += a - (a * cBF < 0 ? cBF : 0));
     dynamic_cast<node_ptr>(_c)->BF += a + (a * rBF > 0 ? rBF : 0);
     _r = _c;
+    pull(_c->child[i]);
+    pull(_c);
+    Rotations::add();
+}
+
+template<class T, class A, class R>
+void AVLTree<T, A, R>::pull(Bnode_ptr r) {
+    if (r != NULL)
+        A::pull(static_cast<node_ptr>(r));
 }
 
-template<class T>
-void AVLTree<T>::fixUnbalance(Bnode_ptr_ref _r, int i, int &sign) {
+template<class T, class A, class R>
+void AVLTree<T, A, R>::fixUnbalance(Bnode_ptr_ref _r, int i, int &sign) {
     int a = i == 0 ? 1 : -1;
     dynamic_cast<node_ptr>(_r)->BF -= a;
     if (dynamic_cast<node_ptr>(_r)->BF * a < -1) {
@@ -217,8 +324,8 @@ void AVLTree<T>::fixUnbalance(Bnode_ptr_ref _r, int i, int &sign) {
         sign = 1;
 }
 
-template<class T>
-typename AVLTree<T>::Bnode_ptr AVLTree<T>::pickMaxAndFix
+template<class T, class A, class R>
+typename AVLTree<T, A, R>::Bnode_ptr AVLTree<T, A, R>::pickMaxAndFix
 (Bnode_ptr_ref _r, int &sign) {
     Bnode_ptr rtn = _r;
     int sign2 = 0;
@@ -233,11 +340,12 @@ typename AVLTree<T>::Bnode_ptr AVLTree<T>::pickMaxAndFix
     rtn = pickMaxAndFix(_r->child[1], sign2);
     if (sign2 == 1)  // ӽڵĸ߶ȼ1
         fixUnbalance(_r, 1, sign);
+    pull(_r);
     return rtn;
 }
 
-template<class T>
-int AVLTree<T>::debugTest(node_ptr p, bool fail) {
+template<class T, class A, class R>
+int AVLTree<T, A, R>::debugTest(node_ptr p, bool fail) {
     int rtn = testAndGetHeight(p);
     if (fail ^ (rtn >= 0)) {
         int unused = 0;
@@ -245,8 +353,8 @@ int AVLTree<T>::debugTest(node_ptr p, bool fail) {
     return rtn;
 }
 
-template<class T>
-int AVLTree<T>::testAndGetHeight(node_ptr r) {
+template<class T, class A, class R>
+int AVLTree<T, A, R>::testAndGetHeight(node_ptr r) {
     if (r == NULL)
         return 0;
     int h0 = testAndGetHeight(dynamic_cast<node_ptr>(r->child[0]));
@@ -0,0 +1,906 @@
+#pragma once
+
+#include <string>
+#include <cstring>
+#include <type_traits>
+#include "SearchTree.h"
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__SSE2__)
+#include <emmintrin.h>
+#define ART_USE_SSE2
+#endif
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+namespace sine {
+namespace tree {
+
+/**
+ * ֽڴתҪΪÿּػṩ
+ * static void bytes(const T &, std::string &out);
+ * ֽڴֵ T  <  == һ£κμһǰ׺
+ */
+template<class T, class Enable = void>
+struct RadixKey;
+
+/**
+ * зתλʹֵֽһ¡
+ * ͣ charlong  int64_t ȱʹ
+ */
+template<class I>
+struct IntegerRadixKey {
+    static void bytes(const I &v, std::string &out) {
+        unsigned long long u = (unsigned long long)v;
+        if ((I)-1 < (I)0)
+            u ^= 1ULL << (sizeof(I) * 8 - 1);
+        out.resize(sizeof(I));
+        for (int i = sizeof(I) - 1; i >= 0; i--, u >>= 8)
+            out[i] = (char)(u & 0xFF);
+    }
+};
+
+template<class I>
+struct RadixKey<I, typename std::enable_if<std::is_integral<I>::value>::type>
+    : IntegerRadixKey<I> {};
+
+/**
+ * ַĩβ 0 ǰ׺Ҫ˲ܰ '\0'
+ */
+template<>
+struct RadixKey<std::string> {
+    static void bytes(const std::string &v, std::string &out) {
+        out.assign(v.c_str(), v.size() + 1);
+    }
+};
+
+/**
+ * ӦART
+ * ڲڵ㰴ӽڵ Node4/16/48/256 ֮л֧·ѹڵǰ׺С
+ * ǰ׺ౣ maxPrefix ֽڣĲִСҶȡá
+ * ӽڵ㰴ֽУ԰ͷΧ
+ */
+template<class T, class K = RadixKey<T> >
+class AdaptiveRadixTree : public virtual SearchTree<T> {
+
+public:
+
+    typedef void(*handler)(ref);
+    typedef void(*const_handler)(const_ref);
+
+    AdaptiveRadixTree();
+    AdaptiveRadixTree(const AdaptiveRadixTree<T, K> &);
+    virtual ~AdaptiveRadixTree();
+
+    virtual bool insert(const_ref);
+    virtual bool remove(const_ref);
+
+    virtual ptr find(const_ref);
+    virtual const_ptr find(const_ref) const;
+
+    virtual bool checkValid() const;
+
+    void traverse(handler);  // 
+    void traverse(const_handler) const;
+    void traverse(const_handler, const_ref lo, const_ref hi) const;  // [lo, hi]
+
+private:
+
+    enum NodeType {
+        leaf, node4, node16, node48, node256
+    };
+
+    static const unsigned maxPrefix = 8;
+
+    class Node {
+    public:
+        unsigned char type;
+        Node(unsigned char type) : type(type) {}
+    };
+    typedef Node * node_ptr;
+
+    class Leaf : public Node {
+    public:
+        T v;
+        Leaf(const_ref v) : Node(leaf), v(v) {}
+    };
+
+    class Inner : public Node {
+    public:
+        unsigned short count;
+        unsigned prefixLen;  // ѹ·ʵʳ
+        unsigned char prefix[maxPrefix];
+        Inner(unsigned char type) : Node(type), count(0), prefixLen(0) {}
+    };
+
+    class Node4 : public Inner {
+    public:
+        unsigned char key[4];
+        node_ptr child[4];
+        Node4() : Inner(node4) {}
+    };
+
+    class Node16 : public Inner {
+    public:
+        unsigned char key[16];
+        node_ptr child[16];
+        Node16() : Inner(node16) {}
+    };
+
+    class Node48 : public Inner {
+    public:
+        unsigned char index[256];  // 0 ʾգΪλ 1
+        node_ptr child[48];
+        Node48() : Inner(node48) {
+            memset(index, 0, sizeof(index));
+            memset(child, 0, sizeof(child));
+        }
+    };
+
+    class Node256 : public Inner {
+    public:
+        node_ptr child[256];
+        Node256() : Inner(node256) {
+            memset(child, 0, sizeof(child));
+        }
+    };
+
+    static bool insertToTree(const_ref, const std::string &, node_ptr &, size_t depth);
+    static bool removeFromTree(const_ref, const std::string &, node_ptr &, size_t depth);
+    static Leaf *findInTree(const_ref, node_ptr);
+
+    static node_ptr *findChild(Inner *, unsigned char);
+    static void addChild(node_ptr &, Inner *, unsigned char, node_ptr);
+    static void removeChild(node_ptr &, Inner *, unsigned char);
+    static int children(Inner *, unsigned char *, node_ptr *);
+
+    static unsigned prefixMismatch(Inner *, const std::string &, size_t depth);
+    static Leaf *minimum(node_ptr);
+    static void copyHeader(Inner *, Inner *);
+
+    static void scan(node_ptr, handler);
+    static void scan(node_ptr, const_handler);
+    static void scanRange(node_ptr, size_t depth, const std::string &lo,
+        const std::string &hi, bool loTight, bool hiTight,
+        const_ref loV, const_ref hiV, const_handler);
+
+    static node_ptr clone(node_ptr);
+    static void destroy(node_ptr);
+    static bool checkRecursive(node_ptr, size_t depth, const_ptr &prev);
+
+    static int lowestBit(unsigned);
+
+    node_ptr root;
+
+};
+
+template<class T, class K>
+AdaptiveRadixTree<T, K>::AdaptiveRadixTree()
+    : root(NULL) {
+}
+
+template<class T, class K>
+AdaptiveRadixTree<T, K>::AdaptiveRadixTree(const AdaptiveRadixTree<T, K> &o)
+    : root(clone(o.root)) {
+}
+
+template<class T, class K>
+AdaptiveRadixTree<T, K>::~AdaptiveRadixTree() {
+    destroy(root);
+}
+
+template<class T, class K>
+bool AdaptiveRadixTree<T, K>::insert(const_ref t) {
+    std::string k;
+    K::bytes(t, k);
+    return insertToTree(t, k, root, 0);
+}
+
+template<class T, class K>
+bool AdaptiveRadixTree<T, K>::remove(const_ref t) {
+    std::string k;
+    K::bytes(t, k);
+    return removeFromTree(t, k, root, 0);
+}
+
+template<class T, class K>
+typename AdaptiveRadixTree<T, K>::ptr AdaptiveRadixTree<T, K>::find(const_ref t) {
+    Leaf *l = findInTree(t, root);
+    return l == NULL ? NULL : &l->v;
+}
+
+template<class T, class K>
+typename AdaptiveRadixTree<T, K>::const_ptr AdaptiveRadixTree<T, K>::find
+(const_ref t) const {
+    Leaf *l = findInTree(t, root);
+    return l == NULL ? NULL : &l->v;
+}
+
+template<class T, class K>
+bool AdaptiveRadixTree<T, K>::checkValid() const {
+    const_ptr prev = NULL;
+    return checkRecursive(root, 0, prev);
+}
+
+template<class T, class K>
+void AdaptiveRadixTree<T, K>::traverse(handler h) {
+    scan(root, h);
+}
+
+template<class T, class K>
+void AdaptiveRadixTree<T, K>::traverse(const_handler h) const {
+    scan(root, h);
+}
+
+template<class T, class K>
+void AdaptiveRadixTree<T, K>::traverse
+(const_handler h, const_ref lo, const_ref hi) const {
+    if (root == NULL || hi < lo)
+        return;
+    std::string l, r;
+    K::bytes(lo, l);
+    K::bytes(hi, r);
+    scanRange(root, 0, l, r, true, true, lo, hi, h);
+}
+
+/**
+ * ǰ׺ֻȽϱĲ֣ҶӴ == ȷϡ
+ */
+template<class T, class K>
+typename AdaptiveRadixTree<T, K>::Leaf *AdaptiveRadixTree<T, K>::findInTree
+(const_ref v, node_ptr n) {
+    if (n == NULL)
+        return NULL;
+    std::string k;
+    K::bytes(v, k);
+    size_t depth = 0;
+    while (n->type != leaf) {
+        Inner *in = static_cast<Inner *>(n);
+        if (in->prefixLen != 0) {
+            unsigned stored = in->prefixLen < maxPrefix ? in->prefixLen : maxPrefix;
+            if (depth + in->prefixLen >= k.size())
+                return NULL;
+            for (unsigned i = 0; i < stored; i++)
+                if (in->prefix[i] != (unsigned char)k[depth + i])
+                    return NULL;
+            depth += in->prefixLen;
+        }
+        if (depth >= k.size())
+            return NULL;
+        node_ptr *c = findChild(in, (unsigned char)k[depth]);
+        if (c == NULL)
+            return NULL;
+        n = *c;
+        depth++;
+    }
+    Leaf *l = static_cast<Leaf *>(n);
+    return v == l->v ? l : NULL;
+}
+
+/**
+ * k Ϊ v ֽڴdepth Ϊ _r ֮ǰƥֽ
+ */
+template<class T, class K>
+bool AdaptiveRadixTree<T, K>::insertToTree
+(const_ref v, const std::string &k, node_ptr &_r, size_t depth) {
+    if (_r == NULL) {
+        _r = new Leaf(v);
+        return true;
+    }
+    if (_r->type == leaf) {  // Ҷӣ½ Node4 ƬҶӡ
+        Leaf *l = static_cast<Leaf *>(_r);
+        if (v == l->v)
+            return false;
+        std::string lk;
+        K::bytes(l->v, lk);
+        size_t p = depth;
+        while (p < lk.size() && p < k.size() && lk[p] == k[p])
+            p++;
+        Node4 *n = new Node4();
+        n->prefixLen = (unsigned)(p - depth);
+        memcpy(n->prefix, k.data() + depth,
+            n->prefixLen < maxPrefix ? n->prefixLen : maxPrefix);
+        node_ptr nn = n;
+        addChild(nn, n, (unsigned char)lk[p], l);
+        addChild(nn, n, (unsigned char)k[p], new Leaf(v));
+        _r = nn;
+        return true;
+    }
+    Inner *in = static_cast<Inner *>(_r);
+    if (in->prefixLen != 0) {
+        unsigned m = prefixMismatch(in, k, depth);
+        if (m < in->prefixLen) {  // ǰ׺ m ֲ棺½ Node4 ӹǰ m ֽڡ
+            Node4 *n = new Node4();
+            n->prefixLen = m;
+            memcpy(n->prefix, in->prefix, m < maxPrefix ? m : maxPrefix);
+            unsigned char b;
+            if (in->prefixLen <= maxPrefix) {
+                b = in->prefix[m];
+                in->prefixLen -= m + 1;
+                memmove(in->prefix, in->prefix + m + 1, in->prefixLen);
+            }
+            else {
+                std::string lk;
+                K::bytes(minimum(in)->v, lk);
+                b = (unsigned char)lk[depth + m];
+                in->prefixLen -= m + 1;
+                memcpy(in->prefix, lk.data() + depth + m + 1,
+                    in->prefixLen < maxPrefix ? in->prefixLen : maxPrefix);
+            }
+            node_ptr nn = n;
+            addChild(nn, n, b, in);
+            addChild(nn, n, (unsigned char)k[depth + m], new Leaf(v));
+            _r = nn;
+            return true;
+        }
+        depth += in->prefixLen;
+    }
+    node_ptr *c = findChild(in, (unsigned char)k[depth]);
+    if (c != NULL)
+        return insertToTree(v, k, *c, depth + 1);
+    addChild(_r, in, (unsigned char)k[depth], new Leaf(v));
+    return true;
+}
+
+template<class T, class K>
+bool AdaptiveRadixTree<T, K>::removeFromTree
+(const_ref v, const std::string &k, node_ptr &_r, size_t depth) {
+    if (_r == NULL)
+        return false;
+    if (_r->type == leaf) {  // ֻиҶ
+        if (!(v == static_cast<Leaf *>(_r)->v))
+            return false;
+        delete static_cast<Leaf *>(_r);
+        _r = NULL;
+        return true;
+    }
+    Inner *in = static_cast<Inner *>(_r);
+    if (in->prefixLen != 0) {
+        unsigned stored = in->prefixLen < maxPrefix ? in->prefixLen : maxPrefix;
+        if (depth + in->prefixLen >= k.size())
+            return false;
+        for (unsigned i = 0; i < stored; i++)
+            if (in->prefix[i] != (unsigned char)k[depth + i])
+                return false;
+        depth += in->prefixLen;
+    }
+    unsigned char b = (unsigned char)k[depth];
+    node_ptr *c = findChild(in, b);
+    if (c == NULL)
+        return false;
+    if ((*c)->type != leaf)
+        return removeFromTree(v, k, *c, depth + 1);
+    Leaf *l = static_cast<Leaf *>(*c);
+    if (!(v == l->v))
+        return false;
+    removeChild(_r, in, b);
+    delete l;
+    return true;
+}
+
+template<class T, class K>
+typename AdaptiveRadixTree<T, K>::node_ptr *AdaptiveRadixTree<T, K>::findChild
+(Inner *n, unsigned char b) {
+    switch (n->type) {
+    case node4: {
+        Node4 *p = static_cast<Node4 *>(n);
+        for (int i = 0; i < p->count; i++)
+            if (p->key[i] == b)
+                return &p->child[i];
+        return NULL;
+    }
+    case node16: {
+        Node16 *p = static_cast<Node16 *>(n);
+#ifdef ART_USE_SSE2
+        __m128i cmp = _mm_cmpeq_epi8(_mm_set1_epi8((char)b),
+            _mm_loadu_si128(reinterpret_cast<const __m128i *>(p->key)));
+        unsigned mask = _mm_movemask_epi8(cmp) & ((1u << p->count) - 1);
+        return mask == 0 ? NULL : &p->child[lowestBit(mask)];
+#else
+        for (int i = 0; i < p->count; i++)
+            if (p->key[i] == b)
+                return &p->child[i];
+        return NULL;
+#endif
+    }
+    case node48: {
+        Node48 *p = static_cast<Node48 *>(n);
+        return p->index[b] == 0 ? NULL : &p->child[p->index[b] - 1];
+    }
+    default: {
+        Node256 *p = static_cast<Node256 *>(n);
+        return p->child[b] == NULL ? NULL : &p->child[b];
+    }
+    }
+}
+
+/**
+ * _r Ϊָ n λãڵʱɸĽڵ㡣
+ */
+template<class T, class K>
+void AdaptiveRadixTree<T, K>::addChild
+(node_ptr &_r, Inner *n, unsigned char b, node_ptr c) {
+    switch (n->type) {
+    case node4: {
+        Node4 *p = static_cast<Node4 *>(n);
+        if (p->count < 4) {
+            int i = p->count;
+            for (; i > 0 && p->key[i - 1] > b; i--) {
+                p->key[i] = p->key[i - 1];
+                p->child[i] = p->child[i - 1];
+            }
+            p->key[i] = b;
+            p->child[i] = c;
+            p->count++;
+            return;
+        }
+        Node16 *g = new Node16();
+        copyHeader(g, p);
+        memcpy(g->key, p->key, sizeof(p->key));
+        memcpy(g->child, p->child, sizeof(p->child));
+        delete p;
+        _r = g;
+        addChild(_r, g, b, c);
+        return;
+    }
+    case node16: {
+        Node16 *p = static_cast<Node16 *>(n);
+        if (p->count < 16) {
+            int i = p->count;
+            for (; i > 0 && p->key[i - 1] > b; i--) {
+                p->key[i] = p->key[i - 1];
+                p->child[i] = p->child[i - 1];
+            }
+            p->key[i] = b;
+            p->child[i] = c;
+            p->count++;
+            return;
+        }
+        Node48 *g = new Node48();
+        copyHeader(g, p);
+        for (int i = 0; i < 16; i++) {
+            g->index[p->key[i]] = (unsigned char)(i + 1);
+            g->child[i] = p->child[i];
+        }
+        delete p;
+        _r = g;
+        addChild(_r, g, b, c);
+        return;
+    }
+    case node48: {
+        Node48 *p = static_cast<Node48 *>(n);
+        if (p->count < 48) {
+            int i = 0;
+            while (p->child[i] != NULL)
+                i++;
+            p->child[i] = c;
+            p->index[b] = (unsigned char)(i + 1);
+            p->count++;
+            return;
+        }
+        Node256 *g = new Node256();
+        copyHeader(g, p);
+        for (int i = 0; i < 256; i++)
+            if (p->index[i] != 0)
+                g->child[i] = p->child[p->index[i] - 1];
+        delete p;
+        _r = g;
+        addChild(_r, g, b, c);
+        return;
+    }
+    default: {
+        Node256 *p = static_cast<Node256 *>(n);
+        p->child[b] = c;
+        p->count++;
+        return;
+    }
+    }
+}
+
+/**
+ * _r Ϊָ n λãӽڵʱɸСĽڵ㣻
+ * Node4 ֻʣһӽڵʱϲ
+ */
+template<class T, class K>
+void AdaptiveRadixTree<T, K>::removeChild
+(node_ptr &_r, Inner *n, unsigned char b) {
+    switch (n->type) {
+    case node4: {
+        Node4 *p = static_cast<Node4 *>(n);
+        int i = 0;
+        while (p->key[i] != b)
+            i++;
+        for (p->count--; i < p->count; i++) {
+            p->key[i] = p->key[i + 1];
+            p->child[i] = p->child[i + 1];
+        }
+        if (p->count > 1)
+            return;
+        node_ptr c = p->child[0];
+        if (c->type != leaf) {  // ϲǰ׺p ǰ׺ + ֽ֧ + c ǰ׺
+            Inner *ci = static_cast<Inner *>(c);
+            unsigned char buf[maxPrefix];
+            unsigned len = p->prefixLen < maxPrefix ? p->prefixLen : maxPrefix;
+            memcpy(buf, p->prefix, len);
+            if (len < maxPrefix)
+                buf[len++] = p->key[0];
+            unsigned cStored = ci->prefixLen < maxPrefix ? ci->prefixLen : maxPrefix;
+            for (unsigned j = 0; len < maxPrefix && j < cStored; j++)
+                buf[len++] = ci->prefix[j];
+            memcpy(ci->prefix, buf, len);
+            ci->prefixLen += p->prefixLen + 1;
+        }
+        delete p;
+        _r = c;
+        return;
+    }
+    case node16: {
+        Node16 *p = static_cast<Node16 *>(n);
+        int i = 0;
+        while (p->key[i] != b)
+            i++;
+        for (p->count--; i < p->count; i++) {
+            p->key[i] = p->key[i + 1];
+            p->child[i] = p->child[i + 1];
+        }
+        if (p->count > 3)
+            return;
+        Node4 *s = new Node4();
+        copyHeader(s, p);
+        memcpy(s->key, p->key, p->count);
+        memcpy(s->child, p->child, p->count * sizeof(node_ptr));
+        delete p;
+        _r = s;
+        return;
+    }
+    case node48: {
+        Node48 *p = static_cast<Node48 *>(n);
+        p->child[p->index[b] - 1] = NULL;
+        p->index[b] = 0;
+        if (--p->count > 12)
+            return;
+        Node16 *s = new Node16();
+        copyHeader(s, p);
+        for (int i = 0, j = 0; i < 256; i++)
+            if (p->index[i] != 0) {
+                s->key[j] = (unsigned char)i;
+                s->child[j++] = p->child[p->index[i] - 1];
+            }
+        delete p;
+        _r = s;
+        return;
+    }
+    default: {
+        Node256 *p = static_cast<Node256 *>(n);
+        p->child[b] = NULL;
+        if (--p->count > 37)
+            return;
+        Node48 *s = new Node48();
+        copyHeader(s, p);
+        for (int i = 0, j = 0; i < 256; i++)
+            if (p->child[i] != NULL) {
+                s->index[i] = (unsigned char)(j + 1);
+                s->child[j++] = p->child[i];
+            }
+        delete p;
+        _r = s;
+        return;
+    }
+    }
+}
+
+/**
+ * ֽȡӽڵ㣬ظ
+ */
+template<class T, class K>
+int AdaptiveRadixTree<T, K>::children
+(Inner *n, unsigned char *keys, node_ptr *out) {
+    int cnt = 0;
+    switch (n->type) {
+    case node4: {
+        Node4 *p = static_cast<Node4 *>(n);
+        for (; cnt < p->count; cnt++) {
+            keys[cnt] = p->key[cnt];
+            out[cnt] = p->child[cnt];
+        }
+        break;
+    }
+    case node16: {
+        Node16 *p = static_cast<Node16 *>(n);
+        for (; cnt < p->count; cnt++) {
+            keys[cnt] = p->key[cnt];
+            out[cnt] = p->child[cnt];
+        }
+        break;
+    }
+    case node48: {
+        Node48 *p = static_cast<Node48 *>(n);
+        for (int i = 0; i < 256; i++)
+            if (p->index[i] != 0) {
+                keys[cnt] = (unsigned char)i;
+                out[cnt++] = p->child[p->index[i] - 1];
+            }
+        break;
+    }
+    default: {
+        Node256 *p = static_cast<Node256 *>(n);
+        for (int i = 0; i < 256; i++)
+            if (p->child[i] != NULL) {
+                keys[cnt] = (unsigned char)i;
+                out[cnt++] = p->child[i];
+            }
+        break;
+    }
+    }
+    return cnt;
+}
+
+/**
+ * ǰ׺ k  depth ʼһͬλãȫͬʱ prefixLen
+ */
+template<class T, class K>
+unsigned AdaptiveRadixTree<T, K>::prefixMismatch
+(Inner *n, const std::string &k, size_t depth) {
+    unsigned stored = n->prefixLen < maxPrefix ? n->prefixLen : maxPrefix;
+    unsigned i = 0;
+    for (; i < stored; i++)
+        if (depth + i >= k.size() || n->prefix[i] != (unsigned char)k[depth + i])
+            return i;
+    if (n->prefixLen > maxPrefix) {
+        std::string lk;
+        K::bytes(minimum(n)->v, lk);
+        for (; i < n->prefixLen; i++)
+            if (depth + i >= k.size() || lk[depth + i] != k[depth + i])
+                return i;
+    }
+    return i;
+}
+
+template<class T, class K>
+typename AdaptiveRadixTree<T, K>::Leaf *AdaptiveRadixTree<T, K>::minimum
+(node_ptr n) {
+    while (n->type != leaf) {
+        switch (n->type) {
+        case node4:
+            n = static_cast<Node4 *>(n)->child[0];
+            break;
+        case node16:
+            n = static_cast<Node16 *>(n)->child[0];
+            break;
+        case node48: {
+            Node48 *p = static_cast<Node48 *>(n);
+            int i = 0;
+            while (p->index[i] == 0)
+                i++;
+            n = p->child[p->index[i] - 1];
+            break;
+        }
+        default: {
+            Node256 *p = static_cast<Node256 *>(n);
+            int i = 0;
+            while (p->child[i] == NULL)
+                i++;
+            n = p->child[i];
+            break;
+        }
+        }
+    }
+    return static_cast<Leaf *>(n);
+}
+
+template<class T, class K>
+void AdaptiveRadixTree<T, K>::copyHeader(Inner *dst, Inner *src) {
+    dst->count = src->count;
+    dst->prefixLen = src->prefixLen;
+    memcpy(dst->prefix, src->prefix, maxPrefix);
+}
+
+template<class T, class K>
+void AdaptiveRadixTree<T, K>::scan(node_ptr n, handler h) {
+    if (n == NULL)
+        return;
+    if (n->type == leaf) {
+        h(static_cast<Leaf *>(n)->v);
+        return;
+    }
+    unsigned char keys[256];
+    node_ptr c[256];
+    int cnt = children(static_cast<Inner *>(n), keys, c);
+    for (int i = 0; i < cnt; i++)
+        scan(c[i], h);
+}
+
+template<class T, class K>
+void AdaptiveRadixTree<T, K>::scan(node_ptr n, const_handler h) {
+    if (n == NULL)
+        return;
+    if (n->type == leaf) {
+        h(static_cast<Leaf *>(n)->v);
+        return;
+    }
+    unsigned char keys[256];
+    node_ptr c[256];
+    int cnt = children(static_cast<Inner *>(n), keys, c);
+    for (int i = 0; i < cnt; i++)
+        scan(c[i], h);
+}
+
+/**
+ * loTight/hiTight ʾǰ· lo/hi ֽڴȻͬ
+ * ֻʱҪֽڼ֦δǰ׺ֽ޷ȽϣҶӴжϡ
+ */
+template<class T, class K>
+void AdaptiveRadixTree<T, K>::scanRange(node_ptr n, size_t depth,
+    const std::string &lo, const std::string &hi, bool loTight, bool hiTight,
+    const_ref loV, const_ref hiV, const_handler h) {
+    if (n->type == leaf) {
+        const_ref v = static_cast<Leaf *>(n)->v;
+        if (!(v < loV) && !(hiV < v))
+            h(v);
+        return;
+    }
+    Inner *in = static_cast<Inner *>(n);
+    unsigned stored = in->prefixLen < maxPrefix ? in->prefixLen : maxPrefix;
+    for (unsigned j = 0; j < in->prefixLen && (loTight || hiTight); j++) {
+        if (j >= stored) {
+            loTight = hiTight = false;
+            break;
+        }
+        unsigned char b = in->prefix[j];
+        if (loTight) {
+            if (depth + j >= lo.size() || b > (unsigned char)lo[depth + j])
+                loTight = false;
+            else if (b < (unsigned char)lo[depth + j])
+                return;
+        }
+        if (hiTight) {
+            if (depth + j >= hi.size() || b > (unsigned char)hi[depth + j])
+                return;
+            else if (b < (unsigned char)hi[depth + j])
+                hiTight = false;
+        }
+    }
+    depth += in->prefixLen;
+    unsigned char keys[256];
+    node_ptr c[256];
+    int cnt = children(in, keys, c);
+    for (int i = 0; i < cnt; i++) {
+        bool lt = loTight, ht = hiTight;
+        if (lt) {
+            if (depth >= lo.size() || keys[i] > (unsigned char)lo[depth])
+                lt = false;
+            else if (keys[i] < (unsigned char)lo[depth])
+                continue;
+        }
+        if (ht) {
+            if (depth >= hi.size() || keys[i] > (unsigned char)hi[depth])
+                return;
+            else if (keys[i] < (unsigned char)hi[depth])
+                ht = false;
+        }
+        scanRange(c[i], depth + 1, lo, hi, lt, ht, loV, hiV, h);
+    }
+}
+
+template<class T, class K>
+typename AdaptiveRadixTree<T, K>::node_ptr AdaptiveRadixTree<T, K>::clone
+(node_ptr n) {
+    if (n == NULL)
+        return NULL;
+    switch (n->type) {
+    case leaf:
+        return new Leaf(*static_cast<Leaf *>(n));
+    case node4: {
+        Node4 *p = new Node4(*static_cast<Node4 *>(n));
+        for (int i = 0; i < p->count; i++)
+            p->child[i] = clone(p->child[i]);
+        return p;
+    }
+    case node16: {
+        Node16 *p = new Node16(*static_cast<Node16 *>(n));
+        for (int i = 0; i < p->count; i++)
+            p->child[i] = clone(p->child[i]);
+        return p;
+    }
+    case node48: {
+        Node48 *p = new Node48(*static_cast<Node48 *>(n));
+        for (int i = 0; i < 48; i++)
+            p->child[i] = clone(p->child[i]);
+        return p;
+    }
+    default: {
+        Node256 *p = new Node256(*static_cast<Node256 *>(n));
+        for (int i = 0; i < 256; i++)
+            p->child[i] = clone(p->child[i]);
+        return p;
+    }
+    }
+}
+
+template<class T, class K>
+void AdaptiveRadixTree<T, K>::destroy(node_ptr n) {
+    if (n == NULL)
+        return;
+    if (n->type == leaf) {
+        delete static_cast<Leaf *>(n);
+        return;
+    }
+    unsigned char keys[256];
+    node_ptr c[256];
+    int cnt = children(static_cast<Inner *>(n), keys, c);
+    for (int i = 0; i < cnt; i++)
+        destroy(c[i]);
+    switch (n->type) {
+    case node4:
+        delete static_cast<Node4 *>(n);
+        break;
+    case node16:
+        delete static_cast<Node16 *>(n);
+        break;
+    case node48:
+        delete static_cast<Node48 *>(n);
+        break;
+    default:
+        delete static_cast<Node256 *>(n);
+        break;
+    }
+}
+
+/**
+ * 飺ҶϸڵСڸ͵ķΧڣ
+ * ǰ׺ͷֽ֧Ҷӵֽڴһ¡
+ */
+template<class T, class K>
+bool AdaptiveRadixTree<T, K>::checkRecursive
+(node_ptr n, size_t depth, const_ptr &prev) {
+    if (n == NULL)
+        return true;
+    if (n->type == leaf) {
+        const_ptr v = &static_cast<Leaf *>(n)->v;
+        if (prev != NULL && !(*prev < *v))
+            return false;
+        prev = v;
+        return true;
+    }
+    Inner *in = static_cast<Inner *>(n);
+    static const int low[] = { 0, 2, 4, 13, 38 };
+    static const int high[] = { 0, 4, 16, 48, 256 };
+    if (in->count < low[in->type] || in->count > high[in->type])
+        return false;
+    unsigned char keys[256];
+    node_ptr c[256];
+    int cnt = children(in, keys, c);
+    if (cnt != in->count)
+        return false;
+    std::string lk;
+    K::bytes(minimum(in)->v, lk);
+    unsigned stored = in->prefixLen < maxPrefix ? in->prefixLen : maxPrefix;
+    if (depth + in->prefixLen >= lk.size() ||
+        memcmp(in->prefix, lk.data() + depth, stored) != 0)
+        return false;
+    depth += in->prefixLen;
+    for (int i = 0; i < cnt; i++) {
+        K::bytes(minimum(c[i])->v, lk);
+        if ((unsigned char)lk[depth] != keys[i])
+            return false;
+        if (!checkRecursive(c[i], depth + 1, prev))
+            return false;
+    }
+    return true;
+}
+
+template<class T, class K>
+int AdaptiveRadixTree<T, K>::lowestBit(unsigned m) {
+#ifdef _MSC_VER
+    unsigned long i;
+    _BitScanForward(&i, m);
+    return (int)i;
+#else
+    return __builtin_ctz(m);
+#endif
+}
+
+}
+}
+
+#undef ART_USE_SSE2
@@ -0,0 +1,115 @@
+#pragma once
+
+#include <limits>
+
+namespace sine {
+namespace tree {
+
+/**
+ * ڵչΪ RBTree/AVLTree ģ
+ * NoAugment κݣAugment<M> ÿڵϱľۺֵ
+ * תͲ롢ɾ·¼㣬ۺϲѯΪ O(log n)
+ * M һ۰Ⱥ
+ *     typedef ... value_type;
+ *     static value_type identity();
+ *     static value_type of(const T &);
+ *     static value_type combine(const value_type &, const value_type &);  // 
+ * ڵ N ṩ live()Ϊ false ʱýڵ㲻ۺϡ
+ */
+struct NoAugment {
+
+    typedef void value_type;
+
+    static const bool enabled = false;
+
+    template<class B>
+    class Node : public B {
+    public:
+        Node() {}
+        template<class V>
+        explicit Node(const V &v) : B(v) {}
+    };
+
+    template<class N>
+    static void pull(N *) {}
+
+};
+
+template<class M>
+struct Augment {
+
+    typedef typename M::value_type value_type;
+
+    static const bool enabled = true;
+
+    template<class B>
+    class Node : public B {
+    public:
+        value_type agg;  // ľۺֵ
+        Node() : agg(M::identity()) {}
+        template<class V>
+        explicit Node(const V &v) : B(v), agg(M::identity()) {}
+    };
+
+    // ӽڵ㣨ȷ¼ n ľۺֵ
+    template<class N>
+    static void pull(N *n) {
+        value_type a = n->live() ? M::of(n->v) : M::identity();
+        if (n->child[0] != NULL)
+            a = M::combine(static_cast<N *>(n->child[0])->agg, a);
+        if (n->child[1] != NULL)
+            a = M::combine(a, static_cast<N *>(n->child[1])->agg);
+        n->agg = a;
+    }
+
+    /**
+     * [*lo, *hi] ԪصľۺֵNULL ʾ޽硣
+     * ֲ֮ÿһֻʣһ磬һȡۺֵ
+     */
+    template<class N, class T>
+    static value_type query(const N *r, const T *lo, const T *hi) {
+        if (r == NULL)
+            return M::identity();
+        if (lo == NULL && hi == NULL)
+            return r->agg;
+        if (lo != NULL && r->v < *lo)
+            return query(static_cast<const N *>(r->child[1]), lo, hi);
+        if (hi != NULL && *hi < r->v)
+            return query(static_cast<const N *>(r->child[0]), lo, hi);
+        value_type a = query(static_cast<const N *>(r->child[0]), lo, (const T *)NULL);
+        if (r->live())
+            a = M::combine(a, M::of(r->v));
+        return M::combine(a, query(static_cast<const N *>(r->child[1]), (const T *)NULL, hi));
+    }
+
+};
+
+/**
+ * õ۰ȺԳԱ m ͡Сֵֵ
+ */
+template<class T, class V, V T::*m>
+struct SumOf {
+    typedef V value_type;
+    static V identity() { return V(); }
+    static V of(const T &t) { return t.*m; }
+    static V combine(const V &a, const V &b) { return a + b; }
+};
+
+template<class T, class V, V T::*m>
+struct MinOf {
+    typedef V value_type;
+    static V identity() { return std::numeric_limits<V>::max(); }
+    static V of(const T &t) { return t.*m; }
+    static V combine(const V &a, const V &b) { return b < a ? b : a; }
+};
+
+template<class T, class V, V T::*m>
+struct MaxOf {
+    typedef V value_type;
+    static V identity() { return std::numeric_limits<V>::lowest(); }
+    static V of(const T &t) { return t.*m; }
+    static V combine(const V &a, const V &b) { return a < b ? b : a; }
+};
+
+}
+}
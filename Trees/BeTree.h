@@ -0,0 +1,720 @@
+#pragma once
+
+#include <cstdio>
+#include <cstring>
+#include <vector>
+#include <list>
+#include <unordered_map>
+#include <algorithm>
+#include <stdexcept>
+#include <type_traits>
+#include "SearchTree.h"
+
+namespace sine {
+namespace tree {
+
+/**
+ *  B 
+ * ڵǱļе 4KB ҳڴ໺ cachePages ҳLRUҳ˳дأ
+ * ڲڵϢupsert/erase ֻϢŽĻ
+ * ʱϢӽڵӦһϢƣҶӲ޸ġ
+ * ƺԼ 1/4 ӽڵڵĺϲϲ޵ٴмֿ൱ڽһ֣
+ * ֻʣһӽڵʱ䰫һ㣻ճҳбʱȸá
+ * 0 ҳǳ飬бڿҳУsync  create = false ´򿪡
+ * T ԰ֽڸƣͬһƽ̨϶дļ
+ */
+template<class T>
+class BeTree : public virtual SearchTree<T> {
+
+public:
+
+    BeTree(const char *path, size_t cachePages = 256, bool create = true);
+    virtual ~BeTree();
+
+    virtual bool insert(const_ref);  // ȲѯԸֵҪ·
+    virtual bool remove(const_ref);
+
+    // ڲĵַһβǰЧ
+    virtual ptr find(const_ref);
+    virtual const_ptr find(const_ref) const;
+
+    virtual bool checkValid() const;
+
+    void upsert(const_ref);  // äдҶ
+    void erase(const_ref);
+    // дȫҳͳ飬ʧʱ׳ std::runtime_error
+    // ʱҲãԴҪ֪ǷдģԼ sync
+    void sync();
+
+    unsigned long long pagesRead() const;
+    unsigned long long pagesWritten() const;
+    size_t pageCount() const;  // ļеҳͿҳ
+    size_t freePageCount() const;
+
+    static const size_t pageSize = 4096;
+    static const size_t fanout = 16;
+
+private:
+
+    class Message {
+    public:
+        T v;
+        bool put;
+        Message(const_ref v, bool put) : v(v), put(put) {}
+        bool operator<(const Message &o) const { return v < o.v; }
+    };
+    typedef typename std::vector<Message>::iterator msg_iter;
+
+    class Node {
+    public:
+        unsigned id;
+        bool leaf, dirty;
+        int pins;
+        std::vector<T> keys;  // ҶӣԪأڲڵ㣺ָ i ķΧ [keys[i-1], keys[i])
+        std::vector<unsigned> child;
+        std::vector<Message> msgs;  // ÿһ
+        Node(unsigned id, bool leaf) : id(id), leaf(leaf), dirty(true), pins(0) {}
+    };
+    typedef Node * node_ptr;
+    typedef std::list<node_ptr> Lru;  // ǰΪʹ
+
+    class Slot {
+    public:
+        node_ptr node;
+        typename Lru::iterator pos;
+    };
+
+    void put(const Message &);
+    void flush(node_ptr);
+    void fixChild(node_ptr, size_t);
+    void splitChild(node_ptr, size_t);
+    void mergeChildren(node_ptr, size_t);  // ӽڵ i + 1  i
+
+    static void mergeMessages(std::vector<Message> &, msg_iter, msg_iter);
+    static void applyToLeaf(node_ptr, msg_iter, msg_iter);
+    static size_t childIndex(node_ptr, const_ref);
+    static bool byId(node_ptr, node_ptr);
+
+    const_ptr lookup(const_ref) const;
+    bool checkRecursive(unsigned, const_ptr lo, const_ptr hi,
+        int depth, int &leafDepth, size_t &used) const;
+
+    node_ptr pin(unsigned) const;
+    void unpin(node_ptr) const;
+    node_ptr allocate(bool leaf);
+    void release(node_ptr);  // ڵֻ߹̶ҳŽб
+    bool fits(node_ptr) const;
+    void evict() const;
+    node_ptr load(unsigned) const;
+    void writeBack(node_ptr) const;
+    void writeSuper() const;
+    void readFreeList(unsigned);
+    void readPage(unsigned, char *) const;
+    void writePage(unsigned, const char *) const;
+
+    template<class V>
+    static V readAt(const char *);
+
+    size_t leafCap, msgCap, cachePages;
+    unsigned root, pages;
+    std::vector<unsigned> freePages;
+    FILE *file;
+    mutable Lru lru;
+    mutable std::unordered_map<unsigned, Slot> cache;
+    mutable std::vector<T> found;
+    mutable unsigned long long reads, writes;
+
+};
+
+template<class T>
+BeTree<T>::BeTree(const char *path, size_t cachePages, bool create)
+    : cachePages(cachePages < 8 ? 8 : cachePages), reads(0), writes(0) {
+    leafCap = (pageSize - 16) / sizeof(T);
+    msgCap = (pageSize - 16 - fanout * sizeof(unsigned) - (fanout - 1) * sizeof(T))
+        / (sizeof(T) + 1);
+    if (msgCap < fanout)
+        throw std::invalid_argument("BeTree: element too large for a page");
+    file = NULL;
+#ifdef _MSC_VER
+    fopen_s(&file, path, create ? "w+b" : "r+b");
+#else
+    file = fopen(path, create ? "w+b" : "r+b");
+#endif
+    if (file == NULL)
+        throw std::runtime_error("BeTree: cannot open file");
+    if (create) {
+        pages = 1;
+        root = allocate(true)->id;
+        unpin(cache[root].node);
+        return;
+    }
+    std::vector<char> page(pageSize);
+    readPage(0, &page[0]);
+    if (readAt<unsigned>(&page[0]) != 0x42655472 ||
+        readAt<unsigned>(&page[12]) != sizeof(T))
+        throw std::runtime_error("BeTree: not a tree file of this element type");
+    root = readAt<unsigned>(&page[4]);
+    pages = readAt<unsigned>(&page[8]);
+    readFreeList(readAt<unsigned>(&page[16]));
+}
+
+template<class T>
+BeTree<T>::~BeTree() {
+    if (file != NULL) {
+        try {
+            sync();
+        }
+        catch (const std::exception &) {  // ׳дֻܶ
+        }
+        fclose(file);
+    }
+    for (typename Lru::iterator i = lru.begin(); i != lru.end(); ++i)
+        delete *i;
+}
+
+template<class T>
+bool BeTree<T>::insert(const_ref t) {
+    if (lookup(t) != NULL)
+        return false;
+    put(Message(t, true));
+    return true;
+}
+
+template<class T>
+bool BeTree<T>::remove(const_ref t) {
+    if (lookup(t) == NULL)
+        return false;
+    put(Message(t, false));
+    return true;
+}
+
+template<class T>
+typename BeTree<T>::ptr BeTree<T>::find(const_ref t) {
+    return const_cast<ptr>(lookup(t));
+}
+
+template<class T>
+typename BeTree<T>::const_ptr BeTree<T>::find(const_ref t) const {
+    return lookup(t);
+}
+
+/**
+ * ⣬ÿһҳҪôУҪôڿбС
+ */
+template<class T>
+bool BeTree<T>::checkValid() const {
+    int leafDepth = -1;
+    size_t used = 0;
+    return checkRecursive(root, NULL, NULL, 0, leafDepth, used)
+        && 1 + used + freePages.size() == pages;
+}
+
+template<class T>
+void BeTree<T>::upsert(const_ref t) {
+    put(Message(t, true));
+}
+
+template<class T>
+void BeTree<T>::erase(const_ref t) {
+    put(Message(t, false));
+}
+
+/**
+ * ҳҳдأ˳д
+ */
+template<class T>
+void BeTree<T>::sync() {
+    std::vector<node_ptr> dirty;
+    for (typename Lru::iterator i = lru.begin(); i != lru.end(); ++i)
+        if ((*i)->dirty)
+            dirty.push_back(*i);
+    std::sort(dirty.begin(), dirty.end(), byId);
+    for (size_t i = 0; i < dirty.size(); i++)
+        writeBack(dirty[i]);
+    writeSuper();
+    fflush(file);
+}
+
+template<class T>
+unsigned long long BeTree<T>::pagesRead() const {
+    return reads;
+}
+
+template<class T>
+unsigned long long BeTree<T>::pagesWritten() const {
+    return writes;
+}
+
+template<class T>
+size_t BeTree<T>::pageCount() const {
+    return pages;
+}
+
+template<class T>
+size_t BeTree<T>::freePageCount() const {
+    return freePages.size();
+}
+
+template<class T>
+void BeTree<T>::put(const Message &m) {
+    node_ptr r = pin(root);
+    std::vector<Message> one(1, m);
+    if (r->leaf)
+        applyToLeaf(r, one.begin(), one.end());
+    else
+        mergeMessages(r->msgs, one.begin(), one.end());
+    r->dirty = true;
+    for (;;) {
+        if (!r->leaf && r->msgs.size() > msgCap)
+            flush(r);
+        if (r->leaf || r->child.size() > 1)
+            break;
+        node_ptr c = pin(r->child[0]);  // ֻʣһӽڵ㣺ӽڵ㣬䰫һ
+        if (c->leaf)
+            applyToLeaf(c, r->msgs.begin(), r->msgs.end());
+        else
+            mergeMessages(c->msgs, r->msgs.begin(), r->msgs.end());
+        c->dirty = true;
+        root = c->id;
+        release(r);
+        r = c;
+    }
+    unpin(r);
+    if (fits(r))
+        return;
+    node_ptr nr = allocate(false);  // ѣһ
+    nr->child.push_back(root);
+    root = nr->id;
+    fixChild(nr, 0);
+    unpin(nr);
+}
+
+/**
+ * ϢӽڵӦһϢƣֱ
+ * ӽڵ fanout ʱֹͣϲѱڵ㡣
+ */
+template<class T>
+void BeTree<T>::flush(node_ptr n) {
+    while (n->msgs.size() > msgCap && n->child.size() <= fanout) {
+        size_t best = 0, bestCount = 0;
+        msg_iter b = n->msgs.begin(), bestB = b, bestE = b;
+        for (size_t i = 0; i < n->child.size(); i++) {
+            msg_iter e = i < n->keys.size() ?
+                std::lower_bound(b, n->msgs.end(), Message(n->keys[i], true)) :
+                n->msgs.end();
+            if ((size_t)(e - b) > bestCount) {
+                best = i;
+                bestCount = e - b;
+                bestB = b;
+                bestE = e;
+            }
+            b = e;
+        }
+        node_ptr c = pin(n->child[best]);
+        if (c->leaf)
+            applyToLeaf(c, bestB, bestE);
+        else
+            mergeMessages(c->msgs, bestB, bestE);
+        c->dirty = true;
+        unpin(c);
+        n->msgs.erase(bestB, bestE);
+        n->dirty = true;
+        fixChild(n, best);
+    }
+}
+
+/**
+ * ӽڵ i ĻСʱƻѣԼ 1/4 ʱڵӽڵϲ
+ * ϲ޵һٷѣ붼ֱٰӽڵ㶼ơ
+ */
+template<class T>
+void BeTree<T>::fixChild(node_ptr n, size_t i) {
+    for (;;) {
+        node_ptr c = pin(n->child[i]);
+        if (!c->leaf && c->msgs.size() > msgCap)
+            flush(c);
+        bool over = c->leaf ? c->keys.size() > leafCap : c->child.size() > fanout;
+        bool under = n->child.size() > 1 &&
+            (c->leaf ? c->keys.size() < leafCap / 4 : c->child.size() < fanout / 4);
+        unpin(c);
+        if (over) {
+            splitChild(n, i);
+            fixChild(n, i + 1);
+        }
+        else if (under) {
+            if (i + 1 == n->child.size())
+                i--;
+            mergeChildren(n, i);
+        }
+        else {
+            return;
+        }
+    }
+}
+
+template<class T>
+void BeTree<T>::splitChild(node_ptr n, size_t i) {
+    node_ptr c = pin(n->child[i]);
+    node_ptr s = allocate(c->leaf);
+    if (c->leaf) {
+        size_t mid = c->keys.size() / 2;
+        s->keys.assign(c->keys.begin() + mid, c->keys.end());
+        c->keys.erase(c->keys.begin() + mid, c->keys.end());
+        n->keys.insert(n->keys.begin() + i, s->keys[0]);
+    }
+    else {
+        size_t mid = c->child.size() / 2;
+        T pivot = c->keys[mid - 1];
+        s->child.assign(c->child.begin() + mid, c->child.end());
+        s->keys.assign(c->keys.begin() + mid, c->keys.end());
+        c->child.erase(c->child.begin() + mid, c->child.end());
+        c->keys.erase(c->keys.begin() + (mid - 1), c->keys.end());
+        msg_iter m = std::lower_bound(c->msgs.begin(), c->msgs.end(), Message(pivot, true));
+        s->msgs.assign(m, c->msgs.end());
+        c->msgs.erase(m, c->msgs.end());
+        n->keys.insert(n->keys.begin() + i, pivot);
+    }
+    n->child.insert(n->child.begin() + (i + 1), s->id);
+    c->dirty = n->dirty = true;
+    unpin(s);
+    unpin(c);
+}
+
+/**
+ * ӽڵ i ļϢСڷָ keys[i]i + 1 ĶСֱӼ
+ */
+template<class T>
+void BeTree<T>::mergeChildren(node_ptr n, size_t i) {
+    node_ptr a = pin(n->child[i]), b = pin(n->child[i + 1]);
+    if (!a->leaf)
+        a->keys.push_back(n->keys[i]);
+    a->keys.insert(a->keys.end(), b->keys.begin(), b->keys.end());
+    a->child.insert(a->child.end(), b->child.begin(), b->child.end());
+    a->msgs.insert(a->msgs.end(), b->msgs.begin(), b->msgs.end());
+    n->keys.erase(n->keys.begin() + i);
+    n->child.erase(n->child.begin() + (i + 1));
+    a->dirty = n->dirty = true;
+    release(b);
+    unpin(a);
+}
+
+/**
+ * [b, e)  dst еϢ£ͬʱǡ
+ */
+template<class T>
+void BeTree<T>::mergeMessages(std::vector<Message> &dst, msg_iter b, msg_iter e) {
+    std::vector<Message> out;
+    out.reserve(dst.size() + (e - b));
+    msg_iter i = dst.begin();
+    while (i != dst.end() || b != e) {
+        if (b == e || (i != dst.end() && i->v < b->v))
+            out.push_back(*i++);
+        else {
+            if (i != dst.end() && i->v == b->v)
+                ++i;
+            out.push_back(*b++);
+        }
+    }
+    dst.swap(out);
+}
+
+template<class T>
+void BeTree<T>::applyToLeaf(node_ptr l, msg_iter b, msg_iter e) {
+    std::vector<T> out;
+    out.reserve(l->keys.size() + (e - b));
+    typename std::vector<T>::iterator i = l->keys.begin();
+    while (i != l->keys.end() || b != e) {
+        if (b == e || (i != l->keys.end() && *i < b->v))
+            out.push_back(*i++);
+        else {
+            if (i != l->keys.end() && *i == b->v)
+                ++i;
+            if (b->put)
+                out.push_back(b->v);
+            ++b;
+        }
+    }
+    l->keys.swap(out);
+}
+
+template<class T>
+size_t BeTree<T>::childIndex(node_ptr n, const_ref v) {
+    return std::upper_bound(n->keys.begin(), n->keys.end(), v) - n->keys.begin();
+}
+
+template<class T>
+bool BeTree<T>::byId(node_ptr a, node_ptr b) {
+    return a->id < b->id;
+}
+
+/**
+ * ϶£ȿеϢҶӡ
+ */
+template<class T>
+typename BeTree<T>::const_ptr BeTree<T>::lookup(const_ref v) const {
+    unsigned id = root;
+    for (;;) {
+        node_ptr n = pin(id);
+        if (n->leaf) {
+            typename std::vector<T>::iterator i =
+                std::lower_bound(n->keys.begin(), n->keys.end(), v);
+            bool hit = i != n->keys.end() && *i == v;
+            if (hit)
+                found.assign(1, *i);
+            unpin(n);
+            return hit ? &found[0] : NULL;
+        }
+        msg_iter m = std::lower_bound(n->msgs.begin(), n->msgs.end(), Message(v, true));
+        if (m != n->msgs.end() && m->v == v) {
+            bool hit = m->put;
+            if (hit)
+                found.assign(1, m->v);
+            unpin(n);
+            return hit ? &found[0] : NULL;
+        }
+        id = n->child[childIndex(n, v)];
+        unpin(n);
+    }
+}
+
+template<class T>
+bool BeTree<T>::checkRecursive
+(unsigned id, const_ptr lo, const_ptr hi, int depth, int &leafDepth, size_t &used) const {
+    node_ptr n = pin(id);
+    bool ok = fits(n);
+    used++;
+    for (size_t i = 0; ok && i < n->keys.size(); i++) {
+        if (i > 0 && !(n->keys[i - 1] < n->keys[i]))
+            ok = false;
+        if ((lo != NULL && n->keys[i] < *lo) || (hi != NULL && !(n->keys[i] < *hi)))
+            ok = false;
+    }
+    if (ok && n->leaf) {
+        if (leafDepth == -1)
+            leafDepth = depth;
+        ok = leafDepth == depth;
+    }
+    if (ok && !n->leaf) {
+        ok = n->child.size() == n->keys.size() + 1;
+        for (size_t i = 0; ok && i < n->msgs.size(); i++) {
+            if (i > 0 && !(n->msgs[i - 1] < n->msgs[i]))
+                ok = false;
+            if ((lo != NULL && n->msgs[i].v < *lo) || (hi != NULL && !(n->msgs[i].v < *hi)))
+                ok = false;
+        }
+        for (size_t i = 0; ok && i < n->child.size(); i++)
+            ok = checkRecursive(n->child[i], i == 0 ? lo : &n->keys[i - 1],
+                i < n->keys.size() ? &n->keys[i] : hi, depth + 1, leafDepth, used);
+    }
+    unpin(n);
+    return ok;
+}
+
+template<class T>
+typename BeTree<T>::node_ptr BeTree<T>::pin(unsigned id) const {
+    typename std::unordered_map<unsigned, Slot>::iterator i = cache.find(id);
+    node_ptr n;
+    if (i != cache.end()) {
+        n = i->second.node;
+        lru.splice(lru.begin(), lru, i->second.pos);
+    }
+    else {
+        n = load(id);
+        lru.push_front(n);
+        Slot s;
+        s.node = n;
+        s.pos = lru.begin();
+        cache[id] = s;
+    }
+    n->pins++;
+    evict();
+    return n;
+}
+
+template<class T>
+void BeTree<T>::unpin(node_ptr n) const {
+    n->pins--;
+}
+
+template<class T>
+typename BeTree<T>::node_ptr BeTree<T>::allocate(bool leaf) {
+    unsigned id;
+    if (freePages.empty()) {
+        id = pages++;
+    }
+    else {
+        id = freePages.back();
+        freePages.pop_back();
+    }
+    node_ptr n = new Node(id, leaf);
+    n->pins = 1;
+    lru.push_front(n);
+    Slot s;
+    s.node = n;
+    s.pos = lru.begin();
+    cache[n->id] = s;
+    evict();
+    return n;
+}
+
+template<class T>
+void BeTree<T>::release(node_ptr n) {
+    typename std::unordered_map<unsigned, Slot>::iterator s = cache.find(n->id);
+    lru.erase(s->second.pos);
+    cache.erase(s);
+    freePages.push_back(n->id);
+    delete n;
+}
+
+template<class T>
+bool BeTree<T>::fits(node_ptr n) const {
+    if (n->leaf)
+        return n->keys.size() <= leafCap;
+    return n->child.size() <= fanout && n->msgs.size() <= msgCap;
+}
+
+/**
+ * ʱ LRU βȡһδʹáܷŽһҳĽڵ㣬ҳ˳дء
+ */
+template<class T>
+void BeTree<T>::evict() const {
+    if (cache.size() <= cachePages)
+        return;
+    size_t batch = cache.size() - cachePages + cachePages / 8;
+    std::vector<node_ptr> victims;
+    for (typename Lru::reverse_iterator i = lru.rbegin();
+         i != lru.rend() && victims.size() < batch; ++i)
+        if ((*i)->pins == 0 && fits(*i))
+            victims.push_back(*i);
+    std::sort(victims.begin(), victims.end(), byId);
+    for (size_t i = 0; i < victims.size(); i++) {
+        node_ptr n = victims[i];
+        if (n->dirty)
+            writeBack(n);
+        typename std::unordered_map<unsigned, Slot>::iterator s = cache.find(n->id);
+        lru.erase(s->second.pos);
+        cache.erase(s);
+        delete n;
+    }
+}
+
+/**
+ * ҳʽleaf, , ӽڵ, Ϣ 4 ֽڣ
+ * ֮ӽڵҳšϢT  1 ֽڲ
+ */
+template<class T>
+typename BeTree<T>::node_ptr BeTree<T>::load(unsigned id) const {
+    std::vector<char> page(pageSize);
+    readPage(id, &page[0]);
+    const char *p = &page[0];
+    node_ptr n = new Node(id, readAt<unsigned>(p) != 0);
+    unsigned nk = readAt<unsigned>(p + 4), nc = readAt<unsigned>(p + 8),
+        nm = readAt<unsigned>(p + 12);
+    p += 16;
+    n->child.reserve(nc);
+    for (unsigned i = 0; i < nc; i++, p += sizeof(unsigned))
+        n->child.push_back(readAt<unsigned>(p));
+    n->keys.reserve(nk);
+    for (unsigned i = 0; i < nk; i++, p += sizeof(T))
+        n->keys.push_back(readAt<T>(p));
+    n->msgs.reserve(nm);
+    for (unsigned i = 0; i < nm; i++, p += sizeof(T) + 1)
+        n->msgs.push_back(Message(readAt<T>(p), p[sizeof(T)] != 0));
+    n->dirty = false;
+    return n;
+}
+
+template<class T>
+void BeTree<T>::writeBack(node_ptr n) const {
+    std::vector<char> page(pageSize, 0);
+    char *p = &page[0];
+    unsigned head[4] = { n->leaf ? 1u : 0u, (unsigned)n->keys.size(),
+        (unsigned)n->child.size(), (unsigned)n->msgs.size() };
+    memcpy(p, head, sizeof(head));
+    p += 16;
+    for (size_t i = 0; i < n->child.size(); i++, p += sizeof(unsigned))
+        memcpy(p, &n->child[i], sizeof(unsigned));
+    for (size_t i = 0; i < n->keys.size(); i++, p += sizeof(T))
+        memcpy(p, &n->keys[i], sizeof(T));
+    for (size_t i = 0; i < n->msgs.size(); i++, p += sizeof(T) + 1) {
+        memcpy(p, &n->msgs[i].v, sizeof(T));
+        p[sizeof(T)] = n->msgs[i].put ? 1 : 0;
+    }
+    writePage(n->id, &page[0]);
+    n->dirty = false;
+}
+
+/**
+ * 飺, , ҳ, sizeof(T), бҳ0 ʾգ
+ * бȡ k ҳÿҳ һҳ, , ҳҳš
+ */
+template<class T>
+void BeTree<T>::writeSuper() const {
+    std::vector<char> page(pageSize, 0);
+    size_t per = (pageSize - 8) / sizeof(unsigned), n = freePages.size();
+    size_t k = (n + per) / (per + 1), at = k;  // k ҳŵ n - k 
+    for (size_t i = 0; i < k; i++) {
+        size_t m = std::min(per, n - at);
+        unsigned head[2] = { i + 1 < k ? freePages[i + 1] : 0u, (unsigned)m };
+        memset(&page[0], 0, pageSize);
+        memcpy(&page[0], head, sizeof(head));
+        if (m > 0)
+            memcpy(&page[8], &freePages[at], m * sizeof(unsigned));
+        writePage(freePages[i], &page[0]);
+        at += m;
+    }
+    memset(&page[0], 0, pageSize);
+    unsigned head[5] = { 0x42655472, root, pages, (unsigned)sizeof(T), k > 0 ? freePages[0] : 0u };
+    memcpy(&page[0], head, sizeof(head));
+    writePage(0, &page[0]);
+}
+
+template<class T>
+void BeTree<T>::readFreeList(unsigned id) {
+    std::vector<char> page(pageSize);
+    for (; id != 0; id = readAt<unsigned>(&page[0])) {
+        readPage(id, &page[0]);
+        freePages.push_back(id);
+        unsigned m = readAt<unsigned>(&page[4]);
+        for (unsigned i = 0; i < m; i++)
+            freePages.push_back(readAt<unsigned>(&page[8 + i * sizeof(unsigned)]));
+    }
+}
+
+template<class T>
+void BeTree<T>::readPage(unsigned id, char *buf) const {
+#ifdef _MSC_VER
+    int r = _fseeki64(file, (long long)id * pageSize, SEEK_SET);
+#else
+    int r = fseeko(file, (off_t)id * pageSize, SEEK_SET);
+#endif
+    if (r != 0 || fread(buf, 1, pageSize, file) != pageSize)
+        throw std::runtime_error("BeTree: read failed");
+    reads++;
+}
+
+template<class T>
+void BeTree<T>::writePage(unsigned id, const char *buf) const {
+#ifdef _MSC_VER
+    int r = _fseeki64(file, (long long)id * pageSize, SEEK_SET);
+#else
+    int r = fseeko(file, (off_t)id * pageSize, SEEK_SET);
+#endif
+    if (r != 0 || fwrite(buf, 1, pageSize, file) != pageSize)
+        throw std::runtime_error("BeTree: write failed");
+    writes++;
+}
+
+/**
+ * δλðֽڸƳһֵ
+ */
+template<class T>
+template<class V>
+V BeTree<T>::readAt(const char *p) {
+    typename std::aligned_storage<sizeof(V), std::alignment_of<V>::value>::type buf;
+    memcpy(&buf, p, sizeof(V));
+    return *reinterpret_cast<V *>(&buf);
+}
+
+}
+}
@@ -1,6 +1,12 @@
 #pragma once
 
+#include <new>
+#include <vector>
+#include <utility>
+#include <algorithm>
+#include <functional>
 #include "AbstractTree.h"
+#include "ThreadPool.h"
 
 namespace sine {
 namespace tree {
@@ -9,6 +15,17 @@ enum Traversal {
     preOrder, inOrder, postOrder
 };
 
+/**
+ * ڴʹ
+ */
+class MemoryStats {
+public:
+    size_t nodes;
+    size_t bytes;  // ڵռõֽɾڵµĿλ
+    double fragmentation;  // ڽеĽڵռıcompact ֮Ϊ 0
+    std::vector<size_t> depths;  // depths[d] ΪΪ d Ľڵ
+};
+
 template<class T>
 class BinaryTree : public virtual AbstractTree<T> {
 
@@ -24,6 +41,20 @@ public:
     void traverse(handler, Traversal);
     void traverse(const_handler, Traversal) const;
 
+    class const_iterator;  // ޸ʧЧ
+
+    // зֳִСf ܲã˳򲻶
+    template<class F>
+    void parallelForEach(F f, ThreadPool &pool = ThreadPool::global()) const;
+
+    // κϲinit + map(v1) + map(v2) + ...combine ɡ
+    template<class R, class Map, class Combine>
+    R parallelReduce(const R &init, Map map, Combine combine,
+        ThreadPool &pool = ThreadPool::global()) const;
+
+    const_iterator begin() const;
+    const_iterator end() const;
+
 protected:
 
     class BinaryNode;
@@ -43,27 +74,107 @@ protected:
 
     Bnode_ptr root;
 
+    void freeNode(Bnode_ptr);  // ɾڵ㣬 delete
+
+    // N ΪʵʵĽڵͣɸƹ졣
+    template<class N>
+    void compactAs();
+    template<class N>
+    MemoryStats statsAs() const;
+
+public:
+
+    class const_iterator {
+    public:
+        const_ref operator*() const;
+        const_ptr operator->() const;
+        const_iterator &operator++();
+        bool operator==(const const_iterator &) const;
+        bool operator!=(const const_iterator &) const;
+    private:
+        friend class BinaryTree<T>;
+        void pushLeft(Bnode_ptr);
+        std::vector<Bnode_ptr> path;  // ջΪǰڵ㣬Ϊδʵ
+    };
+
 private:
 
     void recursiveScan(handler, Bnode_ptr, Traversal);
     void recursiveScan(const_handler, Bnode_ptr, Traversal) const;
 
+    void freeTree(Bnode_ptr);
+
+    static size_t height(Bnode_ptr);
+    //  r  h 㰴 van Emde Boas ˳׷ӵ out
+    static void vebOrder(Bnode_ptr r, size_t h, std::vector<Bnode_ptr> &out);
+    static void atDepth(Bnode_ptr r, size_t d, std::vector<Bnode_ptr> &out);
+
+    // ڵַȽϡ޹ָ < ûж壬std::less ű֤ȫ
+    class AddressLess {
+    public:
+        bool operator()(const std::pair<Bnode_ptr, size_t> &a,
+            const std::pair<Bnode_ptr, size_t> &b) const {
+            return std::less<Bnode_ptr>()(a.first, b.first);
+        }
+    };
+
+    // compact õ򣬽ڵȫɾͷ
+    char *arena, *arenaEnd;
+    size_t arenaLive;
+
+    //  split ֮ڣÿΪ񽻸̳߳ء
+    static int splitDepth(const ThreadPool &);
+
+    template<class F>
+    static void forEach(Bnode_ptr, F &, int split, ThreadPool &);
+    template<class R, class Map, class Combine>
+    static R reduce(Bnode_ptr, Map &, Combine &, int split, ThreadPool &);  // ǿ
+
+    template<class F>
+    class ForEachTask : public ThreadPool::Task {
+    public:
+        ForEachTask(Bnode_ptr r, F *f, int split, ThreadPool *pool)
+            : r(r), f(f), split(split), pool(pool) {}
+        virtual void run() { forEach(r, *f, split, *pool); }
+    private:
+        Bnode_ptr r;
+        F *f;
+        int split;
+        ThreadPool *pool;
+    };
+
+    template<class R, class Map, class Combine>
+    class ReduceTask : public ThreadPool::Task {
+    public:
+        ReduceTask(Bnode_ptr r, Map *map, Combine *combine, int split, ThreadPool *pool, R *out)
+            : r(r), map(map), combine(combine), split(split), pool(pool), out(out) {}
+        virtual void run() { *out = reduce<R>(r, *map, *combine, split, *pool); }
+    private:
+        Bnode_ptr r;
+        Map *map;
+        Combine *combine;
+        int split;
+        ThreadPool *pool;
+        R *out;
+    };
+
 };
 
 template<class T>
-BinaryTree<T>::BinaryTree() {
+BinaryTree<T>::BinaryTree()
+    : arena(NULL), arenaEnd(NULL), arenaLive(0) {
     root = NULL;
 }
 
 template<class T>
-BinaryTree<T>::BinaryTree(const BinaryTree<T> &o) {
-    if (o.root != NULL)
-        root = o.root->clone();
+BinaryTree<T>::BinaryTree(const BinaryTree<T> &o)
+    : arena(NULL), arenaEnd(NULL), arenaLive(0) {
+    root = o.root == NULL ? NULL : o.root->clone();
 }
 
 template<class T>
 BinaryTree<T>::~BinaryTree() {
-    BinaryNode::removeBT(root);
+    freeTree(root);
 }
 
 template<class T>
@@ -76,6 +187,68 @@ void BinaryTree<T>::traverse(const_handler h, Traversal o) const {
     recursiveScan(h, root, o);
 }
 
+template<class T>
+template<class F>
+void BinaryTree<T>::parallelForEach(F f, ThreadPool &pool) const {
+    forEach(root, f, splitDepth(pool), pool);
+}
+
+template<class T>
+template<class R, class Map, class Combine>
+R BinaryTree<T>::parallelReduce(const R &init, Map map, Combine combine, ThreadPool &pool) const {
+    if (root == NULL)
+        return init;
+    return combine(init, reduce<R>(root, map, combine, splitDepth(pool), pool));
+}
+
+template<class T>
+typename BinaryTree<T>::const_iterator BinaryTree<T>::begin() const {
+    const_iterator rtn;
+    rtn.pushLeft(root);
+    return rtn;
+}
+
+template<class T>
+typename BinaryTree<T>::const_iterator BinaryTree<T>::end() const {
+    return const_iterator();
+}
+
+template<class T>
+typename BinaryTree<T>::const_ref BinaryTree<T>::const_iterator::operator*() const {
+    return path.back()->v;
+}
+
+template<class T>
+typename BinaryTree<T>::const_ptr BinaryTree<T>::const_iterator::operator->() const {
+    return &path.back()->v;
+}
+
+template<class T>
+typename BinaryTree<T>::const_iterator &BinaryTree<T>::const_iterator::operator++() {
+    Bnode_ptr r = path.back();
+    path.pop_back();
+    pushLeft(r->child[1]);
+    return *this;
+}
+
+template<class T>
+bool BinaryTree<T>::const_iterator::operator==(const const_iterator &o) const {
+    if (path.empty() || o.path.empty())
+        return path.empty() && o.path.empty();
+    return path.back() == o.path.back();
+}
+
+template<class T>
+bool BinaryTree<T>::const_iterator::operator!=(const const_iterator &o) const {
+    return !(*this == o);
+}
+
+template<class T>
+void BinaryTree<T>::const_iterator::pushLeft(Bnode_ptr r) {
+    for (; r != NULL; r = r->child[0])
+        path.push_back(r);
+}
+
 template<class T>
 BinaryTree<T>::BinaryNode::BinaryNode() {
     memset(child, NULL, 2 * sizeof(Bnode_ptr));
@@ -110,6 +283,52 @@ void BinaryTree<T>::BinaryNode::removeBT(Bnode_ptr root) {
     delete root;
 }
 
+template<class T>
+size_t BinaryTree<T>::height(Bnode_ptr r) {
+    if (r == NULL)
+        return 0;
+    size_t l = height(r->child[0]), h = height(r->child[1]);
+    return (l > h ? l : h) + 1;
+}
+
+template<class T>
+void BinaryTree<T>::vebOrder(Bnode_ptr r, size_t h, std::vector<Bnode_ptr> &out) {
+    if (r == NULL || h == 0)
+        return;
+    if (h == 1) {
+        out.push_back(r);
+        return;
+    }
+    size_t top = h / 2;
+    vebOrder(r, top, out);
+    std::vector<Bnode_ptr> bottom;
+    atDepth(r, top, bottom);
+    for (size_t i = 0; i < bottom.size(); i++)
+        vebOrder(bottom[i], h - top, out);
+}
+
+//  r Ϊ d Ľڵ㣬ҡ
+template<class T>
+void BinaryTree<T>::atDepth(Bnode_ptr r, size_t d, std::vector<Bnode_ptr> &out) {
+    if (r == NULL)
+        return;
+    if (d == 0) {
+        out.push_back(r);
+        return;
+    }
+    atDepth(r->child[0], d - 1, out);
+    atDepth(r->child[1], d - 1, out);
+}
+
+template<class T>
+void BinaryTree<T>::freeTree(Bnode_ptr r) {
+    if (r == NULL)
+        return;
+    freeTree(r->child[0]);
+    freeTree(r->child[1]);
+    freeNode(r);
+}
+
 template<class T>
 void BinaryTree<T>::recursiveScan(handler h, Bnode_ptr root, Traversal o) {
     if (root == NULL)
@@ -124,6 +343,129 @@ void BinaryTree<T>::recursiveScan(handler h, Bnode_ptr root, Traversal o) {
         h(root->v);
 }
 
+template<class T>
+void BinaryTree<T>::freeNode(Bnode_ptr n) {
+    if (n == NULL)
+        return;
+    char *p = reinterpret_cast<char *>(n);
+    if (arena == NULL || p < arena || p >= arenaEnd) {
+        delete n;
+        return;
+    }
+    n->~BinaryNode();
+    if (--arenaLive == 0) {
+        ::operator delete(arena);
+        arena = arenaEnd = NULL;
+    }
+}
+
+/**
+ *  van Emde Boas ˳ȫڵ㸴ƵһµڴУɾԭĽڵ㡣
+ * Ϊ h ȷ h / 2 㣬ηĸÿһڲݹˣ
+ * һβ·ֻԽٵĻУ뻺еĴС޹ء
+ */
+template<class T>
+template<class N>
+void BinaryTree<T>::compactAs() {
+    std::vector<Bnode_ptr> order;
+    vebOrder(root, height(root), order);
+    if (order.empty())
+        return;
+    std::vector<std::pair<Bnode_ptr, size_t> > index(order.size());
+    for (size_t i = 0; i < order.size(); i++)
+        index[i] = std::make_pair(order[i], i);
+    std::sort(index.begin(), index.end(), AddressLess());
+    char *mem = static_cast<char *>(::operator new(order.size() * sizeof(N)));
+    N *to = reinterpret_cast<N *>(mem);
+    for (size_t i = 0; i < order.size(); i++)
+        new (to + i) N(*static_cast<N *>(order[i]));
+    for (size_t i = 0; i < order.size(); i++) {
+        for (int j = 0; j < 2; j++) {
+            Bnode_ptr c = order[i]->child[j];
+            if (c != NULL)
+                to[i].child[j] = to + std::lower_bound(index.begin(), index.end(),
+                    std::make_pair(c, (size_t)0), AddressLess())->second;
+        }
+    }
+    for (size_t i = 0; i < order.size(); i++)
+        freeNode(order[i]);
+    arena = mem;
+    arenaEnd = mem + order.size() * sizeof(N);
+    arenaLive = order.size();
+    root = to;
+}
+
+template<class T>
+template<class N>
+MemoryStats BinaryTree<T>::statsAs() const {
+    MemoryStats rtn;
+    rtn.nodes = 0;
+    std::vector<Bnode_ptr> level;
+    if (root != NULL)
+        level.push_back(root);
+    while (!level.empty()) {
+        rtn.depths.push_back(level.size());
+        rtn.nodes += level.size();
+        std::vector<Bnode_ptr> next;
+        for (size_t i = 0; i < level.size(); i++)
+            for (int j = 0; j < 2; j++)
+                if (level[i]->child[j] != NULL)
+                    next.push_back(level[i]->child[j]);
+        level.swap(next);
+    }
+    size_t slots = (arenaEnd - arena) / sizeof(N);
+    rtn.bytes = (rtn.nodes + slots - arenaLive) * sizeof(N);
+    rtn.fragmentation = rtn.nodes == 0 ? 0 : (rtn.nodes - arenaLive) / (double)rtn.nodes;
+    return rtn;
+}
+
+/**
+ * ԼΪ߳ 8 ƽȡ⡣
+ */
+template<class T>
+int BinaryTree<T>::splitDepth(const ThreadPool &pool) {
+    int d = 0;
+    while (((size_t)1 << d) < pool.size() * 8)
+        d++;
+    return d;
+}
+
+template<class T>
+template<class F>
+void BinaryTree<T>::forEach(Bnode_ptr r, F &f, int split, ThreadPool &pool) {
+    if (r == NULL)
+        return;
+    ThreadPool::TaskGroup g;
+    bool fork = split > 0 && r->child[1] != NULL;
+    if (fork)
+        pool.spawn(new ForEachTask<F>(r->child[1], &f, split - 1, &pool), g);
+    forEach(r->child[0], f, split - 1, pool);
+    f(r->v);
+    if (fork)
+        pool.wait(g);
+    else
+        forEach(r->child[1], f, 0, pool);
+}
+
+template<class T>
+template<class R, class Map, class Combine>
+R BinaryTree<T>::reduce(Bnode_ptr r, Map &map, Combine &combine, int split, ThreadPool &pool) {
+    R mid = map(r->v), right(mid);
+    ThreadPool::TaskGroup g;
+    bool fork = split > 0 && r->child[1] != NULL;
+    if (fork)
+        pool.spawn(new ReduceTask<R, Map, Combine>(r->child[1], &map, &combine, split - 1, &pool, &right), g);
+    R acc = r->child[0] == NULL ? mid : combine(reduce<R>(r->child[0], map, combine, split - 1, pool), mid);
+    if (fork) {
+        pool.wait(g);
+        acc = combine(acc, right);
+    }
+    else if (r->child[1] != NULL) {
+        acc = combine(acc, reduce<R>(r->child[1], map, combine, 0, pool));
+    }
+    return acc;
+}
+
 template<class T>
 void BinaryTree<T>::recursiveScan
 (const_handler h, Bnode_ptr root, Traversal o) const {
@@ -0,0 +1,148 @@
+#pragma once
+
+#include <vector>
+#include "TreeHash.h"
+
+namespace sine {
+namespace tree {
+
+/**
+ * ֿ¡
+ * ÿ 64 ֽڣһУ 128  4 λһԪص k λöͬһڣ
+ * ѯֻһС֧ɾӵ 15 ٱ仯˺󲻻ᱻ 0
+ */
+template<class T, class H = TreeHash<T> >
+class BloomFilter {
+
+public:
+
+    BloomFilter(size_t expected = 1 << 16, int countersPerKey = 12);
+
+    void add(const T &);
+    void remove(const T &);
+    bool mayContain(const T &) const;
+
+    void clear();
+    void reset(size_t expected);  // ղµ
+
+    size_t capacity() const;
+    double falsePositiveRate() const;  // ռʹ
+    size_t memoryUsage() const;  // ֽ
+
+    static const int probes = 4;
+
+private:
+
+    static const int countersPerBlock = 128;
+    static const int wordsPerBlock = 8;
+
+    unsigned long long locate(const T &, size_t &block) const;
+    int get(size_t block, int idx) const;
+    void set(size_t block, int idx, int value);
+
+    std::vector<unsigned long long> words;
+    size_t blocks, expected;
+    int countersPerKey;
+
+};
+
+template<class T, class H>
+BloomFilter<T, H>::BloomFilter(size_t expected, int countersPerKey)
+    : countersPerKey(countersPerKey) {
+    reset(expected);
+}
+
+template<class T, class H>
+void BloomFilter<T, H>::add(const T &v) {
+    size_t b;
+    unsigned long long h = locate(v, b);
+    for (int j = 0; j < probes; j++, h >>= 7) {
+        int idx = (int)(h & 127), c = get(b, idx);
+        if (c < 15)
+            set(b, idx, c + 1);
+    }
+}
+
+template<class T, class H>
+void BloomFilter<T, H>::remove(const T &v) {
+    size_t b;
+    unsigned long long h = locate(v, b);
+    for (int j = 0; j < probes; j++, h >>= 7) {
+        int idx = (int)(h & 127), c = get(b, idx);
+        if (c > 0 && c < 15)
+            set(b, idx, c - 1);
+    }
+}
+
+template<class T, class H>
+bool BloomFilter<T, H>::mayContain(const T &v) const {
+    size_t b;
+    unsigned long long h = locate(v, b);
+    for (int j = 0; j < probes; j++, h >>= 7)
+        if (get(b, (int)(h & 127)) == 0)
+            return false;
+    return true;
+}
+
+template<class T, class H>
+void BloomFilter<T, H>::clear() {
+    words.assign(words.size(), 0);
+}
+
+template<class T, class H>
+void BloomFilter<T, H>::reset(size_t n) {
+    expected = n < 1 ? 1 : n;
+    blocks = (expected * countersPerKey + countersPerBlock - 1) / countersPerBlock;
+    words.assign(blocks * wordsPerBlock, 0);
+}
+
+template<class T, class H>
+size_t BloomFilter<T, H>::capacity() const {
+    return expected;
+}
+
+template<class T, class H>
+double BloomFilter<T, H>::falsePositiveRate() const {
+    double sum = 0;
+    for (size_t b = 0; b < blocks; b++) {
+        int used = 0;
+        for (int idx = 0; idx < countersPerBlock; idx++)
+            if (get(b, idx) != 0)
+                used++;
+        double p = used / (double)countersPerBlock, q = 1;
+        for (int j = 0; j < probes; j++)
+            q *= p;
+        sum += q;
+    }
+    return sum / blocks;
+}
+
+template<class T, class H>
+size_t BloomFilter<T, H>::memoryUsage() const {
+    return words.size() * sizeof(unsigned long long);
+}
+
+/**
+ *  32 λѡ飬 28 λ 4 λá
+ */
+template<class T, class H>
+unsigned long long BloomFilter<T, H>::locate(const T &v, size_t &block) const {
+    unsigned long long h = mixHash(H()(v));
+    block = (size_t)(((h >> 32) * blocks) >> 32);
+    return h;
+}
+
+template<class T, class H>
+int BloomFilter<T, H>::get(size_t block, int idx) const {
+    return (int)(words[block * wordsPerBlock + (idx >> 4)] >> ((idx & 15) * 4)) & 15;
+}
+
+template<class T, class H>
+void BloomFilter<T, H>::set(size_t block, int idx, int value) {
+    unsigned long long &w = words[block * wordsPerBlock + (idx >> 4)];
+    int shift = (idx & 15) * 4;
+    w = (w & ~(15ULL << shift)) | ((unsigned long long)value << shift);
+}
+
+}
+}
@@ -0,0 +1,160 @@
+#pragma once
+
+#include "RBTree.h"
+#include "BloomFilter.h"
+
+namespace sine {
+namespace tree {
+
+/**
+ * ڶǰһ¡
+ * ͬɾڵԪ find/remove ʱֱӷأ·
+ * Ԫʱؽ
+ * ıԪؼϵڶinsertremoveԼ Engine Ϊ FingerBT ʱĴʾ
+ * 麯ͨ FingerBT  RBTree õҲһ
+ *  traverse ޸Ԫأһ£find/remove ©Ԫء
+ */
+template<class T, class Engine = RBTree<T>, class H = TreeHash<T> >
+class BloomFilteredTree : public Engine {
+
+public:
+
+    BloomFilteredTree(size_t expected = 1 << 16);
+
+    virtual bool insert(const_ref);
+    virtual bool remove(const_ref);
+    bool insert(const_ptr hint, const_ref);  //  Engine ṩʾʱ
+
+    virtual ptr find(const_ref);
+    virtual const_ptr find(const_ref) const;
+
+    double falsePositiveRate() const;  // ֵ
+    double observedFalsePositiveRate() const;  // ڵԪͨı
+    size_t filterMemoryUsage() const;
+
+private:
+
+    void added(const_ref);
+    bool pass(const_ref) const;
+    void miss() const;
+
+    static void fill(BloomFilter<T, H> &, Bnode_ptr);
+
+    BloomFilter<T, H> filter;
+    size_t size;
+    mutable unsigned long long rejected, falseHits;
+
+};
+
+template<class T, class Engine, class H>
+BloomFilteredTree<T, Engine, H>::BloomFilteredTree(size_t expected)
+    : filter(expected), size(0), rejected(0), falseHits(0) {
+}
+
+template<class T, class Engine, class H>
+bool BloomFilteredTree<T, Engine, H>::insert(const_ref t) {
+    if (!Engine::insert(t))
+        return false;
+    added(t);
+    return true;
+}
+
+/**
+ * ʱ FingerBT ת insert(const_ref)ԪѾ
+ */
+template<class T, class Engine, class H>
+bool BloomFilteredTree<T, Engine, H>::insert(const_ptr hint, const_ref t) {
+    if (root == NULL)
+        return Engine::insert(hint, t);
+    if (!Engine::insert(hint, t))
+        return false;
+    added(t);
+    return true;
+}
+
+template<class T, class Engine, class H>
+bool BloomFilteredTree<T, Engine, H>::remove(const_ref t) {
+    if (!pass(t))
+        return false;
+    if (!Engine::remove(t)) {
+        miss();
+        return false;
+    }
+    filter.remove(t);
+    size--;
+    return true;
+}
+
+template<class T, class Engine, class H>
+typename BloomFilteredTree<T, Engine, H>::ptr BloomFilteredTree<T, Engine, H>::find
+(const_ref t) {
+    if (!pass(t))
+        return NULL;
+    ptr p = Engine::find(t);
+    if (p == NULL)
+        miss();
+    return p;
+}
+
+template<class T, class Engine, class H>
+typename BloomFilteredTree<T, Engine, H>::const_ptr BloomFilteredTree<T, Engine, H>::find
+(const_ref t) const {
+    if (!pass(t))
+        return NULL;
+    const_ptr p = Engine::find(t);
+    if (p == NULL)
+        miss();
+    return p;
+}
+
+template<class T, class Engine, class H>
+double BloomFilteredTree<T, Engine, H>::falsePositiveRate() const {
+    return filter.falsePositiveRate();
+}
+
+template<class T, class Engine, class H>
+double BloomFilteredTree<T, Engine, H>::observedFalsePositiveRate() const {
+    unsigned long long absent = rejected + falseHits;
+    return absent == 0 ? 0 : falseHits / (double)absent;
+}
+
+template<class T, class Engine, class H>
+size_t BloomFilteredTree<T, Engine, H>::filterMemoryUsage() const {
+    return filter.memoryUsage();
+}
+
+template<class T, class Engine, class H>
+void BloomFilteredTree<T, Engine, H>::added(const_ref t) {
+    if (++size > filter.capacity()) {
+        filter.reset(filter.capacity() * 2);
+        fill(filter, root);
+    }
+    else {
+        filter.add(t);
+    }
+}
+
+template<class T, class Engine, class H>
+bool BloomFilteredTree<T, Engine, H>::pass(const_ref t) const {
+    if (filter.mayContain(t))
+        return true;
+    rejected++;
+    return false;
+}
+
+template<class T, class Engine, class H>
+void BloomFilteredTree<T, Engine, H>::miss() const {
+    falseHits++;
+}
+
+template<class T, class Engine, class H>
+void BloomFilteredTree<T, Engine, H>::fill(BloomFilter<T, H> &f, Bnode_ptr r) {
+    if (r == NULL)
+        return;
+    f.add(r->v);
+    fill(f, r->child[0]);
+    fill(f, r->child[1]);
+}
+
+}
+}
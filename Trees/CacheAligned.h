@@ -0,0 +1,46 @@
+#pragma once
+
+#include <cstdlib>
+#include <new>
+
+#ifdef _MSC_VER
+#include <malloc.h>
+#endif
+
+namespace sine {
+namespace tree {
+
+/**
+ * ռеĶĻ
+ * ĴС 64 ı 64 ֽڶ䣬ڶ󲻻α
+ * C++17 ֮ǰ new ֤ alignof(max_align_t) Ķ룬Լ䡣
+ */
+class alignas(64) CacheAligned {
+
+public:
+
+    static void *operator new(size_t n) {
+        void *p = NULL;
+#ifdef _MSC_VER
+        p = _aligned_malloc(n, 64);
+#else
+        if (posix_memalign(&p, 64, n) != 0)
+            p = NULL;
+#endif
+        if (p == NULL)
+            throw std::bad_alloc();
+        return p;
+    }
+
+    static void operator delete(void *p) {
+#ifdef _MSC_VER
+        _aligned_free(p);
+#else
+        free(p);
+#endif
+    }
+
+};
+
+}
+}
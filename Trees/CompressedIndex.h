@@ -0,0 +1,324 @@
+#pragma once
+
+#include <vector>
+#include <cstring>
+#include <algorithm>
+#include <type_traits>
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__SSE2__)
+#include <emmintrin.h>
+#define CI_USE_SSE2
+#endif
+
+namespace sine {
+namespace tree {
+
+/**
+ * ֻѹ
+ * һĶ飩֮޸ġ
+ * ÿ 128 Ϊһ飬ڴԿ׼ƫƣframe of reference
+ * ƫѡ 124  8 ֽڿֻ׼
+ * ڶ֣ SSE2 һαȽ 168  4 ƫƣͳСĿĸ
+ * Χɨ谴 SSE2 롣һøÿȵֵȽʱᱻ롣
+ * K Ϊ͡
+ */
+template<class K>
+class CompressedIndex {
+
+    static_assert(std::is_integral<K>::value, "CompressedIndex needs integral keys");
+
+public:
+
+    static const size_t blockSize = 128;
+
+    template<class Tree>
+    explicit CompressedIndex(const Tree &);  // ȡ Tree ȫԪ
+    explicit CompressedIndex(const std::vector<K> &sorted);
+
+    bool find(K) const;
+    size_t lower_bound(K) const;  // һС x ļţûΪ size()
+    K at(size_t) const;
+
+    //  [lo, hi] ڵÿ fؼĸ
+    template<class F>
+    size_t range(K lo, K hi, F f) const;
+
+    size_t size() const;
+    size_t memoryUsage() const;  // ֽ
+
+private:
+
+    typedef typename std::make_unsigned<K>::type U;
+
+    class Block {
+    public:
+        size_t at;  //  data еʼλ
+        int width;  // ÿƫƵֽ
+    };
+
+    void build(const std::vector<K> &);
+    size_t blockOf(K) const;  // ܺ x Ŀ飬x СȫʱΪ 0
+    size_t countLess(size_t b, unsigned long long t) const;  //  b Сƫ t ĸ
+    size_t blockCount(size_t b) const;
+    void decode(size_t b, K *out) const;
+
+    static unsigned long long load(const unsigned char *, int width);
+    static unsigned long long limit(int width);
+
+    std::vector<K> firsts;
+    std::vector<Block> blocks;
+    std::vector<unsigned char> data;
+    size_t count;
+
+};
+
+template<class K>
+const size_t CompressedIndex<K>::blockSize;
+
+template<class K>
+template<class Tree>
+CompressedIndex<K>::CompressedIndex(const Tree &t)
+    : count(0) {
+    std::vector<K> keys;
+    for (typename Tree::const_iterator i = t.begin(); i != t.end(); ++i)
+        keys.push_back(*i);
+    build(keys);
+}
+
+template<class K>
+CompressedIndex<K>::CompressedIndex(const std::vector<K> &sorted)
+    : count(0) {
+    build(sorted);
+}
+
+template<class K>
+bool CompressedIndex<K>::find(K x) const {
+    if (count == 0 || x < firsts[0])
+        return false;
+    size_t b = blockOf(x);
+    unsigned long long t = (U)((U)x - (U)firsts[b]);
+    size_t c = countLess(b, t);
+    return c < blockCount(b) && load(&data[blocks[b].at] + c * blocks[b].width, blocks[b].width) == t;
+}
+
+template<class K>
+size_t CompressedIndex<K>::lower_bound(K x) const {
+    if (count == 0 || x < firsts[0])
+        return 0;
+    size_t b = blockOf(x);
+    return b * blockSize + countLess(b, (U)((U)x - (U)firsts[b]));
+}
+
+template<class K>
+K CompressedIndex<K>::at(size_t i) const {
+    const Block &b = blocks[i / blockSize];
+    return (K)((U)firsts[i / blockSize]
+        + (U)load(&data[b.at] + i % blockSize * b.width, b.width));
+}
+
+template<class K>
+template<class F>
+size_t CompressedIndex<K>::range(K lo, K hi, F f) const {
+    if (hi < lo)
+        return 0;
+    size_t s = lower_bound(lo), e = lower_bound(hi);
+    if (e < count && at(e) == hi)
+        e++;
+    K buf[blockSize];
+    for (size_t i = s; i < e; ) {  // ˶ȷڲٱȽ
+        size_t b = i / blockSize, m = std::min(e - b * blockSize, blockSize);
+        if (m - i % blockSize < blockSize / 8) {  // ֻȡʱֵ
+            for (; i < b * blockSize + m; i++)
+                f(at(i));
+            continue;
+        }
+        decode(b, buf);
+        for (size_t j = i % blockSize; j < m; j++)
+            f(buf[j]);
+        i = (b + 1) * blockSize;
+    }
+    return e - s;
+}
+
+template<class K>
+size_t CompressedIndex<K>::size() const {
+    return count;
+}
+
+template<class K>
+size_t CompressedIndex<K>::memoryUsage() const {
+    return sizeof(*this) + firsts.capacity() * sizeof(K)
+        + blocks.capacity() * sizeof(Block) + data.capacity();
+}
+
+template<class K>
+void CompressedIndex<K>::build(const std::vector<K> &keys) {
+    count = keys.size();
+    size_t total = 0;
+    for (size_t i = 0; i < count; i += blockSize) {
+        size_t last = std::min(i + blockSize, count) - 1;
+        unsigned long long span = (U)((U)keys[last] - (U)keys[i]);
+        Block b;
+        b.at = total;
+        b.width = span <= limit(1) ? 1 : span <= limit(2) ? 2 : span <= limit(4) ? 4 : 8;
+        total += blockSize * b.width;
+        firsts.push_back(keys[i]);
+        blocks.push_back(b);
+    }
+    data.resize(total);
+    for (size_t k = 0; k < blocks.size(); k++) {
+        int w = blocks[k].width;
+        unsigned char *p = &data[blocks[k].at];
+        for (size_t j = 0; j < blockSize; j++) {
+            size_t i = k * blockSize + j;
+            unsigned long long o = i < count ? (U)((U)keys[i] - (U)firsts[k]) : limit(w);
+            unsigned char b1 = (unsigned char)o;
+            unsigned short b2 = (unsigned short)o;
+            unsigned int b4 = (unsigned int)o;
+            memcpy(p + j * w, w == 1 ? (const void *)&b1 : w == 2 ? (const void *)&b2
+                : w == 4 ? (const void *)&b4 : (const void *)&o, w);
+        }
+    }
+}
+
+template<class K>
+size_t CompressedIndex<K>::blockOf(K x) const {
+    return std::upper_bound(firsts.begin(), firsts.end(), x) - firsts.begin() - 1;
+}
+
+/**
+ * ƫС t ĸǿڵ lower_bound
+ * SSE2 ֻзűȽϣ߶תλеıȽϽ-1ۼ
+ * ÿ 32 sad ֽ͡
+ */
+template<class K>
+size_t CompressedIndex<K>::countLess(size_t b, unsigned long long t) const {
+    int w = blocks[b].width;
+    if (t > limit(w))
+        return blockCount(b);
+    const unsigned char *p = &data[blocks[b].at];
+#ifdef CI_USE_SSE2
+    if (w < 8) {
+        const __m128i *v = reinterpret_cast<const __m128i *>(p);
+        __m128i bias, x, acc = _mm_setzero_si128();
+        switch (w) {
+        case 1:
+            bias = _mm_set1_epi8((char)0x80);
+            x = _mm_xor_si128(_mm_set1_epi8((char)t), bias);
+            for (int i = 0; i < 8; i++)
+                acc = _mm_sub_epi8(acc, _mm_cmplt_epi8(_mm_xor_si128(_mm_loadu_si128(v + i), bias), x));
+            break;
+        case 2:
+            bias = _mm_set1_epi16((short)0x8000);
+            x = _mm_xor_si128(_mm_set1_epi16((short)t), bias);
+            for (int i = 0; i < 16; i++)
+                acc = _mm_sub_epi16(acc, _mm_cmplt_epi16(_mm_xor_si128(_mm_loadu_si128(v + i), bias), x));
+            break;
+        default:
+            bias = _mm_set1_epi32((int)0x80000000);
+            x = _mm_xor_si128(_mm_set1_epi32((int)t), bias);
+            for (int i = 0; i < 32; i++)
+                acc = _mm_sub_epi32(acc, _mm_cmplt_epi32(_mm_xor_si128(_mm_loadu_si128(v + i), bias), x));
+            break;
+        }
+        __m128i sum = _mm_sad_epu8(acc, _mm_setzero_si128());
+        return (size_t)(_mm_cvtsi128_si32(sum) + _mm_cvtsi128_si32(_mm_srli_si128(sum, 8)));
+    }
+#endif
+    size_t lo = 0, hi = blockCount(b);
+    while (lo < hi) {
+        size_t mid = (lo + hi) / 2;
+        if (load(p + mid * w, w) < t)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+    return lo;
+}
+
+template<class K>
+size_t CompressedIndex<K>::blockCount(size_t b) const {
+    return std::min(blockSize, count - b * blockSize);
+}
+
+/**
+ * Ȱƫչ 32 λУټ׼64 λļչһΣ
+ */
+template<class K>
+void CompressedIndex<K>::decode(size_t b, K *out) const {
+    int w = blocks[b].width;
+    const unsigned char *p = &data[blocks[b].at];
+#ifdef CI_USE_SSE2
+    if (w < 8 && (sizeof(K) == 4 || sizeof(K) == 8)) {
+        const __m128i *v = reinterpret_cast<const __m128i *>(p);
+        __m128i *o = reinterpret_cast<__m128i *>(out), z = _mm_setzero_si128();
+        __m128i lanes[blockSize / 4];
+        for (int i = 0; i < 8 * w; i++) {
+            __m128i x = _mm_loadu_si128(v + i);
+            if (w == 1) {
+                __m128i lo = _mm_unpacklo_epi8(x, z), hi = _mm_unpackhi_epi8(x, z);
+                lanes[4 * i] = _mm_unpacklo_epi16(lo, z);
+                lanes[4 * i + 1] = _mm_unpackhi_epi16(lo, z);
+                lanes[4 * i + 2] = _mm_unpacklo_epi16(hi, z);
+                lanes[4 * i + 3] = _mm_unpackhi_epi16(hi, z);
+            }
+            else if (w == 2) {
+                lanes[2 * i] = _mm_unpacklo_epi16(x, z);
+                lanes[2 * i + 1] = _mm_unpackhi_epi16(x, z);
+            }
+            else {
+                lanes[i] = x;
+            }
+        }
+        if (sizeof(K) == 4) {
+            __m128i base = _mm_set1_epi32((int)firsts[b]);
+            for (size_t i = 0; i < blockSize / 4; i++)
+                _mm_storeu_si128(o + i, _mm_add_epi32(lanes[i], base));
+        }
+        else {
+            long long f = (long long)firsts[b];
+            __m128i base = _mm_set_epi32((int)(f >> 32), (int)f, (int)(f >> 32), (int)f);
+            for (size_t i = 0; i < blockSize / 4; i++) {
+                _mm_storeu_si128(o + 2 * i, _mm_add_epi64(_mm_unpacklo_epi32(lanes[i], z), base));
+                _mm_storeu_si128(o + 2 * i + 1, _mm_add_epi64(_mm_unpackhi_epi32(lanes[i], z), base));
+            }
+        }
+        return;
+    }
+#endif
+    for (size_t i = 0; i < blockSize; i++)
+        out[i] = (K)((U)firsts[b] + (U)load(p + i * w, w));
+}
+
+template<class K>
+unsigned long long CompressedIndex<K>::load(const unsigned char *p, int w) {
+    switch (w) {
+    case 1:
+        return *p;
+    case 2: {
+        unsigned short x;
+        memcpy(&x, p, 2);
+        return x;
+    }
+    case 4: {
+        unsigned int x;
+        memcpy(&x, p, 4);
+        return x;
+    }
+    default: {
+        unsigned long long x;
+        memcpy(&x, p, 8);
+        return x;
+    }
+    }
+}
+
+template<class K>
+unsigned long long CompressedIndex<K>::limit(int w) {
+    return w >= 8 ? ~0ULL : (1ULL << (8 * w)) - 1;
+}
+
+}
+}
+
+#undef CI_USE_SSE2
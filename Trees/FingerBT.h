@@ -0,0 +1,141 @@
+#pragma once
+
+#include <vector>
+#include "SelfBalancedBT.h"
+
+namespace sine {
+namespace tree {
+
+/**
+ * ִ֧ʾƽ
+ * סһβλõ·fingerʾʱ·
+ * ġΧԪصĽڵ㿪ʼ룬·޸ֱб仯
+ * ˳׷ʱֻ賣̽Ͼ̯ƽ޸
+ * ͨṩԼĲ޸
+ */
+template<class T>
+class FingerBT : public SelfBalancedBT<T> {
+
+public:
+
+    using SearchTree<T>::insert;
+
+    // hint Ԫصĵַ NULLͨȡ finger()
+    // 麯ڲʱάĸӽṹȣͨͬ
+    virtual bool insert(const_ptr hint, const_ref);
+
+    const_ptr finger() const;  // һδʾԪأûΪ NULL
+
+protected:
+
+    //  _r ʼ룬sign Լһźš
+    virtual Bnode_ptr insertSubtree(const_ref, Bnode_ptr_ref, int &sign) = 0;
+    // ӽڵ i ź sign޸ _r ΪźţǷҪϡ
+    virtual bool propagateInsert(Bnode_ptr_ref, int i, int &sign) = 0;
+    virtual void afterInsert() = 0;
+
+    void dropFinger();  // ޸Ĳ֮
+
+private:
+
+    class Level {
+    public:
+        Bnode_ptr *slot;  // ָ򱾲ڵ
+        int dir;  // һķ
+        int lo, hi;  // ޶Χڲ㣬-1 ʾ޽
+    };
+
+    // ʱ·ָԭ
+    class Finger : public std::vector<Level> {
+    public:
+        Finger() {}
+        Finger(const Finger &) {}
+        Finger &operator=(const Finger &) {
+            clear();
+            return *this;
+        }
+    };
+
+    bool contains(size_t, const_ref) const;
+    void descend(size_t, const_ref);
+
+    Finger path;
+
+};
+
+template<class T>
+bool FingerBT<T>::insert(const_ptr hint, const_ref t) {
+    if (root == NULL) {
+        bool rtn = insert(t);
+        path.clear();
+        Level top = { &root, 0, -1, -1 };
+        path.push_back(top);
+        descend(0, t);
+        return rtn;
+    }
+    if (hint == NULL || path.empty() || hint != finger()) {
+        path.clear();
+        Level top = { &root, 0, -1, -1 };
+        path.push_back(top);
+        if (hint != NULL)
+            descend(0, *hint);
+    }
+    size_t k = path.size() - 1;
+    while (k > 0 && !contains(k, t))
+        k--;
+    path.resize(k + 1);
+    int sign;
+    Bnode_ptr p = insertSubtree(t, *path[k].slot, sign);
+    if (p != NULL) {
+        while (k > 0) {  // ޸һµ·ѱתı
+            bool more = propagateInsert(*path[k - 1].slot, path[k - 1].dir, sign);
+            k--;
+            if (!more)
+                break;
+        }
+        afterInsert();
+        path.resize(k + 1);
+    }
+    descend(k, t);
+    return p != NULL;
+}
+
+template<class T>
+typename FingerBT<T>::const_ptr FingerBT<T>::finger() const {
+    return path.empty() ? NULL : &(*path.back().slot)->v;
+}
+
+template<class T>
+void FingerBT<T>::dropFinger() {
+    path.clear();
+}
+
+template<class T>
+bool FingerBT<T>::contains(size_t k, const_ref v) const {
+    int lo = path[k].lo, hi = path[k].hi;
+    return (lo < 0 || (*path[lo].slot)->v < v) && (hi < 0 || v < (*path[hi].slot)->v);
+}
+
+/**
+ * ӵ k 㿪ʼ v ֱ̽ҵ v ûӽڵ㡣
+ */
+template<class T>
+void FingerBT<T>::descend(size_t k, const_ref v) {
+    path.resize(k + 1);
+    for (;;) {
+        Level &l = path.back();
+        Bnode_ptr n = *l.slot;
+        if (v == n->v)
+            return;
+        l.dir = v < n->v ? 0 : 1;
+        if (n->child[l.dir] == NULL)
+            return;
+        int cur = (int)path.size() - 1;
+        Level next = { &n->child[l.dir], 0,
+            l.dir == 1 ? cur : l.lo, l.dir == 0 ? cur : l.hi };
+        path.push_back(next);
+    }
+}
+
+}
+}
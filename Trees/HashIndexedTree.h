@@ -0,0 +1,207 @@
+#pragma once
+
+#include <vector>
+#include "RBTree.h"
+#include "TreeHash.h"
+
+namespace sine {
+namespace tree {
+
+/**
+ * ɢĶ
+ * ԱάһſѰַ̽⣩ɢбԪڽڵеĵַ
+ * find ֻɢб O(1)ĲۺϵȣȻ
+ * װӱ 1/8  1/2 ֮䣬ÿԪڱռ 2 ֳƽ 4  16 ֳ
+ * Engine 뱣֤Ԫڽڵеλò䣺RBTreeAVLTreeNormalBSTSplayTree ԣ
+ * ScapegoatTree ؽʱƶԪأʹáʾĲ벻ͨá
+ */
+template<class T, class Engine = RBTree<T>, class H = TreeHash<T> >
+class HashIndexedTree : public Engine {
+
+public:
+
+    HashIndexedTree();
+    HashIndexedTree(const HashIndexedTree<T, Engine, H> &);
+
+    virtual bool insert(const_ref);
+    virtual bool remove(const_ref);
+
+    virtual ptr find(const_ref);
+    virtual const_ptr find(const_ref) const;
+
+    virtual bool checkValid() const;  // ͬʱһ
+
+    void compact();  //  Engine ṩ compact ʱãڵᶯؽ
+
+    size_t indexMemoryUsage() const;
+
+private:
+
+    class Slot {
+    public:
+        unsigned long long hash;
+        ptr p;  // NULL ʾλ
+    };
+
+    static unsigned long long hashOf(const_ref);
+
+    size_t slotOf(const_ref, unsigned long long) const;  // ԪڻӦڵλ
+    void add(ptr);
+    void erase(size_t);
+    void resize(size_t capacity);
+    void rebuild(size_t capacity);
+
+    std::vector<Slot> table;  // СΪ 2 
+    size_t count;
+
+};
+
+template<class T, class Engine, class H>
+HashIndexedTree<T, Engine, H>::HashIndexedTree()
+    : count(0) {
+    rebuild(16);
+}
+
+template<class T, class Engine, class H>
+HashIndexedTree<T, Engine, H>::HashIndexedTree(const HashIndexedTree<T, Engine, H> &o)
+    : BinaryTree<T>(o), Engine(o), count(0) {  // ิ
+    rebuild(o.table.size());
+}
+
+template<class T, class Engine, class H>
+bool HashIndexedTree<T, Engine, H>::insert(const_ref t) {
+    if (find(t) != NULL || !Engine::insert(t))
+        return false;
+    add(const_cast<ptr>(static_cast<const Engine *>(this)->Engine::find(t)));
+    return true;
+}
+
+template<class T, class Engine, class H>
+bool HashIndexedTree<T, Engine, H>::remove(const_ref t) {
+    size_t i = slotOf(t, hashOf(t));
+    if (table[i].p == NULL)
+        return false;
+    erase(i);
+    Engine::remove(t);
+    return true;
+}
+
+template<class T, class Engine, class H>
+typename HashIndexedTree<T, Engine, H>::ptr HashIndexedTree<T, Engine, H>::find(const_ref t) {
+    return table[slotOf(t, hashOf(t))].p;
+}
+
+template<class T, class Engine, class H>
+typename HashIndexedTree<T, Engine, H>::const_ptr HashIndexedTree<T, Engine, H>::find
+(const_ref t) const {
+    return table[slotOf(t, hashOf(t))].p;
+}
+
+template<class T, class Engine, class H>
+bool HashIndexedTree<T, Engine, H>::checkValid() const {
+    if (!Engine::checkValid())
+        return false;
+    size_t n = 0;
+    for (size_t i = 0; i < table.size(); i++) {
+        if (table[i].p == NULL)
+            continue;
+        n++;
+        if (Engine::find(*table[i].p) != table[i].p)
+            return false;
+        if (slotOf(*table[i].p, table[i].hash) != i)
+            return false;
+    }
+    return n == count;
+}
+
+template<class T, class Engine, class H>
+void HashIndexedTree<T, Engine, H>::compact() {
+    Engine::compact();
+    rebuild(table.size());
+}
+
+template<class T, class Engine, class H>
+size_t HashIndexedTree<T, Engine, H>::indexMemoryUsage() const {
+    return table.size() * sizeof(Slot);
+}
+
+template<class T, class Engine, class H>
+unsigned long long HashIndexedTree<T, Engine, H>::hashOf(const_ref t) {
+    return mixHash(H()(t));
+}
+
+/**
+ * ȱȽϱɢֵֻͬʱŷʽڵеԪء
+ */
+template<class T, class Engine, class H>
+size_t HashIndexedTree<T, Engine, H>::slotOf(const_ref t, unsigned long long h) const {
+    size_t mask = table.size() - 1;
+    size_t i = (size_t)h & mask;
+    while (table[i].p != NULL && !(table[i].hash == h && *table[i].p == t))
+        i = (i + 1) & mask;
+    return i;
+}
+
+template<class T, class Engine, class H>
+void HashIndexedTree<T, Engine, H>::add(ptr p) {
+    if ((count + 1) * 2 > table.size())
+        resize(table.size() * 2);
+    unsigned long long h = hashOf(*p);
+    Slot &s = table[slotOf(*p, h)];
+    s.hash = h;
+    s.p = p;
+    count++;
+}
+
+/**
+ * ɾѺͬһ̽ϵԪǰƣɾǡ
+ * װӵ 1/8 ʱСһ롣
+ */
+template<class T, class Engine, class H>
+void HashIndexedTree<T, Engine, H>::erase(size_t i) {
+    size_t mask = table.size() - 1;
+    table[i].p = NULL;
+    count--;
+    for (size_t j = (i + 1) & mask; table[j].p != NULL; j = (j + 1) & mask) {
+        size_t home = (size_t)table[j].hash & mask;
+        if (((j - home) & mask) >= ((j - i) & mask)) {  // home  (i, j] ڣƵ i
+            table[i] = table[j];
+            table[j].p = NULL;
+            i = j;
+        }
+    }
+    if (table.size() > 16 && count * 8 < table.size())
+        resize(table.size() / 2);
+}
+
+template<class T, class Engine, class H>
+void HashIndexedTree<T, Engine, H>::resize(size_t capacity) {
+    std::vector<Slot> old(capacity);
+    old.swap(table);
+    size_t mask = table.size() - 1;
+    for (size_t i = 0; i < old.size(); i++) {
+        if (old[i].p == NULL)
+            continue;
+        size_t j = (size_t)old[i].hash & mask;
+        while (table[j].p != NULL)
+            j = (j + 1) & mask;
+        table[j] = old[i];
+    }
+}
+
+/**
+ * ½ģʽѱɾĽڵ㡣
+ */
+template<class T, class Engine, class H>
+void HashIndexedTree<T, Engine, H>::rebuild(size_t capacity) {
+    Slot empty = { 0, NULL };
+    table.assign(capacity, empty);
+    count = 0;
+    const Engine *e = this;
+    for (typename Engine::const_iterator j = e->begin(); j != e->end(); ++j)
+        if (e->Engine::find(*j) == &*j)
+            add(const_cast<ptr>(&*j));
+}
+
+}
+}
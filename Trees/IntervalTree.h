@@ -0,0 +1,91 @@
+#pragma once
+
+#include <limits>
+#include "RBTree.h"
+
+namespace sine {
+namespace tree {
+
+/**
+ *  [lo, hi] lo ٰ hi 
+ */
+template<class T>
+class Interval {
+public:
+    T lo, hi;
+    Interval(const T &lo, const T &hi) : lo(lo), hi(hi) {}
+    bool operator==(const Interval<T> &o) const {
+        return lo == o.lo && hi == o.hi;
+    }
+    bool operator<(const Interval<T> &o) const {
+        return lo < o.lo || (lo == o.lo && hi < o.hi);
+    }
+};
+
+/**
+ * Ҷ˵㡣T Ϊ͡
+ */
+template<class T>
+struct MaxEndpoint {
+    typedef T value_type;
+    static T identity() { return std::numeric_limits<T>::lowest(); }
+    static T of(const Interval<T> &i) { return i.hi; }
+    static T combine(const T &a, const T &b) { return a < b ? b : a; }
+};
+
+/**
+ * 
+ * ÿڵ㱣Ҷ˵㣬ת¡
+ * ѯʱҶ˵Сڲѯ½Լ˵ڲѯϽ
+ * ʵĽڵ㶼ڸĳ·ϻЩ·ÿ· O(log n)
+ * ˱ k ĲѯΪ O(min(n, k log n))
+ */
+template<class T>
+class IntervalTree : public RBTree<Interval<T>, Augment<MaxEndpoint<T> > > {
+
+public:
+
+    // ÿ [lo, hi] ཻ f
+    template<class F>
+    size_t overlapping(const T &lo, const T &hi, F f) const;
+
+    // ÿ x  f
+    template<class F>
+    size_t stabbing(const T &x, F f) const;
+
+private:
+
+    template<class F>
+    static size_t search(node_ptr, const T &lo, const T &hi, F &f);
+
+};
+
+template<class T>
+template<class F>
+size_t IntervalTree<T>::overlapping(const T &lo, const T &hi, F f) const {
+    return search(static_cast<node_ptr>(root), lo, hi, f);
+}
+
+template<class T>
+template<class F>
+size_t IntervalTree<T>::stabbing(const T &x, F f) const {
+    return search(static_cast<node_ptr>(root), x, x, f);
+}
+
+template<class T>
+template<class F>
+size_t IntervalTree<T>::search(node_ptr r, const T &lo, const T &hi, F &f) {
+    if (r == NULL || r->agg < lo)
+        return 0;
+    size_t count = search(static_cast<node_ptr>(r->child[0]), lo, hi, f);
+    if (hi < r->v.lo)  // ˵㶼
+        return count;
+    if (r->live() && !(r->v.hi < lo)) {
+        f(r->v);
+        count++;
+    }
+    return count + search(static_cast<node_ptr>(r->child[1]), lo, hi, f);
+}
+
+}
+}
@@ -0,0 +1,485 @@
+#pragma once
+
+#include <cmath>
+#include <vector>
+#include <utility>
+#include <algorithm>
+#include "BinaryTree.h"
+#include "SearchTree.h"
+
+namespace sine {
+namespace tree {
+
+/**
+ * Ԫڸάϵ꣬ҪΪÿԪػṩ
+ *     typedef ... value_type;  // ɱȽϣתΪ double
+ *     static value_type at(const T &, int dim);  // dim Ϊ 0  Dims - 1
+ */
+template<class T>
+struct KdKey;
+
+/**
+ * k-d 
+ * ڵͨ BinaryNodeΪ d Ľڵ㰴 d % Dims ά֣άʱαȽ
+ * άСά궼ͬԪΪͬһ
+ * Ԫذϸ򣬼ʹĳһάظλҲƽġ
+ * ʱλ֣ʱһؽ
+ * ɾͨ k-d ɾΪʱȰұߣаò㻮άСĽڵ
+ * ٵݹժǸڵ㣬 O(n^(1 - 1/Dims))ɾʱؽ
+ * ؽֻԭнڵ㣬find صָԪرɾ֮ǰһֱЧ
+ */
+template<class T, int Dims, class K = KdKey<T> >
+class KdTree : public virtual BinaryTree<T>, public virtual SearchTree<T> {
+
+public:
+
+    typedef typename K::value_type coord_type;
+
+    KdTree(double alpha = 0.7);  // alpha ȡ (0.5, 1)
+    explicit KdTree(const std::vector<T> &, double alpha = 0.7);  // 
+
+    void build(const std::vector<T> &);  // 滻ȫԪ
+
+    virtual bool insert(const_ref);
+    virtual bool remove(const_ref);
+
+    virtual ptr find(const_ref);
+    virtual const_ptr find(const_ref) const;
+
+    virtual bool checkValid() const;
+    bool checkBalance() const;
+
+    // ÿһά [lo, hi] ڵԪص f˳򲻶Ԫظ
+    template<class F>
+    size_t range(const_ref lo, const_ref hi, F f) const;
+
+    //  q ŷϾ k ԪأɽԶ
+    void nearest(const_ref q, size_t k, std::vector<const_ptr> &out) const;
+
+private:
+
+    class ByDim {
+    public:
+        int dim;
+        explicit ByDim(int dim) : dim(dim) {}
+        bool operator()(Bnode_ptr a, Bnode_ptr b) const {
+            return less(a->v, b->v, dim);
+        }
+    };
+
+    typedef std::pair<double, const_ptr> Candidate;
+
+    static bool same(const_ref, const_ref);
+    static bool less(const_ref, const_ref, int dim);  // ӵ dim άʼȽϵĳ
+    static int side(const_ref, Bnode_ptr, int depth);  // Ӧ
+    static double distance(const_ref, const_ref);  // ƽ
+
+    static Bnode_ptr insertToTree
+        (const_ref, Bnode_ptr_ref, int depth, int limit, double alpha, int &sign);
+
+    static Bnode_ptr detach(Bnode_ptr_ref, int depth);  // Ϊ depth Ľڵժ²
+    static Bnode_ptr *minSlot(Bnode_ptr *, int depth, int dim, int &at);
+
+    static void rebuild(Bnode_ptr_ref, int depth);
+    static void flatten(Bnode_ptr, std::vector<Bnode_ptr> &);
+    static Bnode_ptr build(std::vector<Bnode_ptr> &, size_t lo, size_t hi, int depth);
+
+    template<class F>
+    static size_t rangeSearch(Bnode_ptr, int depth, const_ref lo, const_ref hi, F &f);
+    static void nearestSearch
+        (Bnode_ptr, int depth, const_ref q, size_t k, std::vector<Candidate> &heap);
+
+    static bool checkValidRecursive(Bnode_ptr, int depth, const_ptr *lo, const_ptr *hi);
+
+    void clear();
+    static int count(Bnode_ptr);
+    static int height(Bnode_ptr);
+    int heightLimit(int) const;
+
+    double alpha;
+    int size, maxSize;
+
+};
+
+template<class T, int Dims, class K>
+KdTree<T, Dims, K>::KdTree(double alpha)
+    : alpha(alpha), size(0), maxSize(0) {
+}
+
+template<class T, int Dims, class K>
+KdTree<T, Dims, K>::KdTree(const std::vector<T> &v, double alpha)
+    : alpha(alpha), size(0), maxSize(0) {
+    build(v);
+}
+
+/**
+ * ȰάֵȥظԪأ㰴λ֡
+ */
+template<class T, int Dims, class K>
+void KdTree<T, Dims, K>::build(const std::vector<T> &v) {
+    clear();
+    std::vector<Bnode_ptr> nodes;
+    for (size_t i = 0; i < v.size(); i++)
+        nodes.push_back(new BinaryNode(v[i]));
+    std::sort(nodes.begin(), nodes.end(), ByDim(0));
+    size_t n = 0;
+    for (size_t i = 0; i < nodes.size(); i++) {
+        if (n > 0 && same(nodes[n - 1]->v, nodes[i]->v))
+            freeNode(nodes[i]);
+        else
+            nodes[n++] = nodes[i];
+    }
+    nodes.resize(n);
+    root = build(nodes, 0, n, 0);
+    size = maxSize = (int)n;
+}
+
+template<class T, int Dims, class K>
+bool KdTree<T, Dims, K>::insert(const_ref t) {
+    if (root == NULL) {
+        root = new BinaryNode(t);
+        size = maxSize = 1;
+        return true;
+    }
+    int sign = 0;
+    if (insertToTree(t, root, 0, heightLimit(size + 1), alpha, sign) == NULL)
+        return false;
+    if (++size > maxSize)
+        maxSize = size;
+    return true;
+}
+
+template<class T, int Dims, class K>
+bool KdTree<T, Dims, K>::remove(const_ref t) {
+    Bnode_ptr *slot = &root;
+    int depth = 0;
+    while (*slot != NULL && !same(t, (*slot)->v)) {
+        slot = &(*slot)->child[side(t, *slot, depth)];
+        depth++;
+    }
+    if (*slot == NULL)
+        return false;
+    freeNode(detach(*slot, depth));
+    if (--size < alpha * maxSize) {
+        rebuild(root, 0);
+        maxSize = size;
+    }
+    return true;
+}
+
+template<class T, int Dims, class K>
+typename KdTree<T, Dims, K>::ptr KdTree<T, Dims, K>::find(const_ref t) {
+    return const_cast<ptr>(static_cast<const KdTree<T, Dims, K> *>(this)->find(t));
+}
+
+template<class T, int Dims, class K>
+typename KdTree<T, Dims, K>::const_ptr KdTree<T, Dims, K>::find(const_ref t) const {
+    Bnode_ptr r = root;
+    for (int depth = 0; r != NULL; depth++) {
+        if (same(t, r->v))
+            return &r->v;
+        r = r->child[side(t, r, depth)];
+    }
+    return NULL;
+}
+
+template<class T, int Dims, class K>
+bool KdTree<T, Dims, K>::checkValid() const {
+    const_ptr lo[Dims], hi[Dims];
+    for (int d = 0; d < Dims; d++)
+        lo[d] = hi[d] = NULL;
+    return count(root) == size && checkValidRecursive(root, 0, lo, hi);
+}
+
+template<class T, int Dims, class K>
+bool KdTree<T, Dims, K>::checkBalance() const {
+    return height(root) <= heightLimit(maxSize);
+}
+
+template<class T, int Dims, class K>
+template<class F>
+size_t KdTree<T, Dims, K>::range(const_ref lo, const_ref hi, F f) const {
+    return rangeSearch(root, 0, lo, hi, f);
+}
+
+/**
+ * Ŀǰ k ѣһڻάϵľѲСڵ k ľʱ
+ */
+template<class T, int Dims, class K>
+void KdTree<T, Dims, K>::nearest(const_ref q, size_t k, std::vector<const_ptr> &out) const {
+    std::vector<Candidate> heap;
+    out.clear();
+    if (k == 0)
+        return;
+    nearestSearch(root, 0, q, k, heap);
+    std::sort_heap(heap.begin(), heap.end());
+    for (size_t i = 0; i < heap.size(); i++)
+        out.push_back(heap[i].second);
+}
+
+template<class T, int Dims, class K>
+bool KdTree<T, Dims, K>::same(const_ref a, const_ref b) {
+    for (int d = 0; d < Dims; d++)
+        if (K::at(a, d) < K::at(b, d) || K::at(b, d) < K::at(a, d))
+            return false;
+    return true;
+}
+
+template<class T, int Dims, class K>
+bool KdTree<T, Dims, K>::less(const_ref a, const_ref b, int dim) {
+    for (int i = 0; i < Dims; i++) {
+        int d = (dim + i) % Dims;
+        if (K::at(a, d) < K::at(b, d))
+            return true;
+        if (K::at(b, d) < K::at(a, d))
+            return false;
+    }
+    return false;
+}
+
+template<class T, int Dims, class K>
+int KdTree<T, Dims, K>::side(const_ref t, Bnode_ptr r, int depth) {
+    return less(t, r->v, depth % Dims) ? 0 : 1;
+}
+
+template<class T, int Dims, class K>
+double KdTree<T, Dims, K>::distance(const_ref a, const_ref b) {
+    double s = 0;
+    for (int d = 0; d < Dims; d++) {
+        double x = (double)K::at(a, d) - (double)K::at(b, d);
+        s += x * x;
+    }
+    return s;
+}
+
+/**
+ * ָܿ롣
+ * ½ڵȳ limit ʱsign Ϊݵǰڵ
+ * ҵؽΪ 0
+ */
+template<class T, int Dims, class K>
+typename KdTree<T, Dims, K>::Bnode_ptr KdTree<T, Dims, K>::insertToTree
+(const_ref v, Bnode_ptr_ref _r, int depth, int limit, double alpha, int &sign) {
+    if (same(v, _r->v))
+        return NULL;
+    int i = side(v, _r, depth);
+    Bnode_ptr_ref _c = _r->child[i];
+    Bnode_ptr p;
+    int sign2 = 0;
+    if (_c == NULL) {
+        p = _c = new BinaryNode(v);
+        if (depth + 1 > limit)
+            sign2 = 1;
+    }
+    else {
+        p = insertToTree(v, _c, depth + 1, limit, alpha, sign2);
+        if (p == NULL)
+            return NULL;
+    }
+    if (sign2 > 0) {
+        int s = sign2 + count(_r->child[1 - i]) + 1;
+        if (sign2 > alpha * s)  // ǰڵ
+            rebuild(_r, depth);
+        else
+            sign = s;
+    }
+    return p;
+}
+
+/**
+ * ָܿ롣
+ * ĳСڱɾĽڵ㣬Ķдӻά𳬼С
+ * ڵԶΪʱȰұߣڵ㶼ڶߣȻ
+ * ݹժֻƶڵ㣬Ԫء
+ */
+template<class T, int Dims, class K>
+typename KdTree<T, Dims, K>::Bnode_ptr KdTree<T, Dims, K>::detach(Bnode_ptr_ref _r, int depth) {
+    Bnode_ptr del = _r;
+    if (del->child[0] == NULL && del->child[1] == NULL) {
+        _r = NULL;
+        return del;
+    }
+    if (del->child[1] == NULL) {
+        del->child[1] = del->child[0];
+        del->child[0] = NULL;
+    }
+    int at;
+    Bnode_ptr *m = minSlot(&del->child[1], depth + 1, depth % Dims, at);
+    Bnode_ptr rep = detach(*m, at);
+    rep->child[0] = del->child[0];
+    rep->child[1] = del->child[1];
+    _r = rep;
+    del->child[0] = NULL;
+    del->child[1] = NULL;
+    return del;
+}
+
+/**
+ * ָܿ롣
+ * дӵ dim ά𳬼СĽڵڵӣat Ϊȡ
+ *  dim ֵĽڵֻ迴ڵ߶Ҫ
+ */
+template<class T, int Dims, class K>
+typename KdTree<T, Dims, K>::Bnode_ptr *KdTree<T, Dims, K>::minSlot
+(Bnode_ptr *slot, int depth, int dim, int &at) {
+    Bnode_ptr r = *slot;
+    if (depth % Dims == dim) {
+        if (r->child[0] != NULL)
+            return minSlot(&r->child[0], depth + 1, dim, at);
+        at = depth;
+        return slot;
+    }
+    Bnode_ptr *best = slot;
+    at = depth;
+    for (int i = 0; i < 2; i++) {
+        if (r->child[i] == NULL)
+            continue;
+        int d;
+        Bnode_ptr *c = minSlot(&r->child[i], depth + 1, dim, d);
+        if (less((*c)->v, (*best)->v, dim)) {
+            best = c;
+            at = d;
+        }
+    }
+    return best;
+}
+
+// Ϊ depth  _r λؽ
+template<class T, int Dims, class K>
+void KdTree<T, Dims, K>::rebuild(Bnode_ptr_ref _r, int depth) {
+    std::vector<Bnode_ptr> nodes;
+    flatten(_r, nodes);
+    _r = build(nodes, 0, nodes.size(), depth);
+}
+
+template<class T, int Dims, class K>
+void KdTree<T, Dims, K>::flatten(Bnode_ptr r, std::vector<Bnode_ptr> &nodes) {
+    if (r == NULL)
+        return;
+    flatten(r->child[0], nodes);
+    nodes.push_back(r);
+    flatten(r->child[1], nodes);
+}
+
+// ȡλ
+template<class T, int Dims, class K>
+typename KdTree<T, Dims, K>::Bnode_ptr KdTree<T, Dims, K>::build
+(std::vector<Bnode_ptr> &nodes, size_t lo, size_t hi, int depth) {
+    if (lo >= hi)
+        return NULL;
+    size_t mid = (lo + hi) / 2;
+    std::nth_element(nodes.begin() + lo, nodes.begin() + mid, nodes.begin() + hi,
+        ByDim(depth % Dims));
+    Bnode_ptr m = nodes[mid];
+    m->child[0] = build(nodes, lo, mid, depth + 1);
+    m->child[1] = build(nodes, mid + 1, hi, depth + 1);
+    return m;
+}
+
+/**
+ * ڻά϶ڵǰڵ㣬½ʱͬ
+ */
+template<class T, int Dims, class K>
+template<class F>
+size_t KdTree<T, Dims, K>::rangeSearch
+(Bnode_ptr r, int depth, const_ref lo, const_ref hi, F &f) {
+    if (r == NULL)
+        return 0;
+    size_t n = 0;
+    bool inside = true;
+    for (int d = 0; d < Dims && inside; d++)
+        inside = !(K::at(r->v, d) < K::at(lo, d)) && !(K::at(hi, d) < K::at(r->v, d));
+    if (inside) {
+        f(r->v);
+        n++;
+    }
+    int d = depth % Dims;
+    if (!(K::at(r->v, d) < K::at(lo, d)))
+        n += rangeSearch(r->child[0], depth + 1, lo, hi, f);
+    if (!(K::at(hi, d) < K::at(r->v, d)))
+        n += rangeSearch(r->child[1], depth + 1, lo, hi, f);
+    return n;
+}
+
+template<class T, int Dims, class K>
+void KdTree<T, Dims, K>::nearestSearch
+(Bnode_ptr r, int depth, const_ref q, size_t k, std::vector<Candidate> &heap) {
+    if (r == NULL)
+        return;
+    double dist = distance(q, r->v);
+    if (heap.size() < k) {
+        heap.push_back(Candidate(dist, &r->v));
+        std::push_heap(heap.begin(), heap.end());
+    }
+    else if (dist < heap.front().first) {
+        std::pop_heap(heap.begin(), heap.end());
+        heap.back() = Candidate(dist, &r->v);
+        std::push_heap(heap.begin(), heap.end());
+    }
+    int d = depth % Dims;
+    double x = (double)K::at(q, d) - (double)K::at(r->v, d);
+    int i = x < 0 ? 0 : 1;
+    nearestSearch(r->child[i], depth + 1, q, k, heap);
+    if (heap.size() < k || x * x < heap.front().first)
+        nearestSearch(r->child[1 - i], depth + 1, q, k, heap);
+}
+
+// lo[d]hi[d] Ϊ d άֵȸĳ磬NULL ʾ޽硣
+template<class T, int Dims, class K>
+bool KdTree<T, Dims, K>::checkValidRecursive
+(Bnode_ptr r, int depth, const_ptr *lo, const_ptr *hi) {
+    if (r == NULL)
+        return true;
+    for (int d = 0; d < Dims; d++) {
+        if (lo[d] != NULL && !less(*lo[d], r->v, d))
+            return false;
+        if (hi[d] != NULL && !less(r->v, *hi[d], d))
+            return false;
+    }
+    int d = depth % Dims;
+    const_ptr b[Dims];
+    std::copy(hi, hi + Dims, b);
+    b[d] = &r->v;
+    if (!checkValidRecursive(r->child[0], depth + 1, lo, b))
+        return false;
+    std::copy(lo, lo + Dims, b);
+    b[d] = &r->v;
+    return checkValidRecursive(r->child[1], depth + 1, b, hi);
+}
+
+template<class T, int Dims, class K>
+void KdTree<T, Dims, K>::clear() {
+    std::vector<Bnode_ptr> nodes;
+    flatten(root, nodes);
+    for (size_t i = 0; i < nodes.size(); i++)
+        freeNode(nodes[i]);
+    root = NULL;
+    size = maxSize = 0;
+}
+
+template<class T, int Dims, class K>
+int KdTree<T, Dims, K>::count(Bnode_ptr r) {
+    if (r == NULL)
+        return 0;
+    return count(r->child[0]) + count(r->child[1]) + 1;
+}
+
+// ԱƵĸ߶ȣΪ -1
+template<class T, int Dims, class K>
+int KdTree<T, Dims, K>::height(Bnode_ptr r) {
+    if (r == NULL)
+        return -1;
+    int h0 = height(r->child[0]), h1 = height(r->child[1]);
+    return (h0 > h1 ? h0 : h1) + 1;
+}
+
+//  log(n) / log(1 / alpha)
+template<class T, int Dims, class K>
+int KdTree<T, Dims, K>::heightLimit(int n) const {
+    if (n <= 1)
+        return 0;
+    return (int)std::floor(std::log((double)n) / std::log(1 / alpha));
+}
+
+}
+}
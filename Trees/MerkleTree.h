@@ -0,0 +1,143 @@
+#pragma once
+
+#include <vector>
+#include "RBTree.h"
+#include "TreeHash.h"
+
+namespace sine {
+namespace tree {
+
+/**
+ * ɢУԪɢֵ֮ͣģ 2^64
+ * ˳״޹أתıļϣ˲ıֵ
+ */
+template<class T, class H = ContentHash<T> >
+struct SetHash {
+    typedef unsigned long long value_type;
+    static value_type identity() { return 0; }
+    static value_type of(const T &t) {  // ȼһɢֵΪ 0 Ԫز
+        return mixHash(H()(t) + 0x9E3779B97F4A7C15ULL);
+    }
+    static value_type combine(const value_type &a, const value_type &b) { return a + b; }
+};
+
+/**
+ * ɢеĺڱȽϺͬ
+ * ÿڵ㱣ļɢУ롢ɾת¡
+ * diff ر̽ÿڵԼɢһͬһΧɢУO(log n)Ƚϣ
+ * ͬķΧĸȣĴС޹ء
+ * Ԫذ == ҶӦԪأ HȫݵɢУжǷͬ
+ */
+template<class T, class H = ContentHash<T> >
+class MerkleTree : public RBTree<T, Augment<SetHash<T, H> > > {
+
+public:
+
+    typedef unsigned long long hash_type;
+
+    hash_type hash() const;  // ɢУͬͬ
+
+    // ֻڱһеԪذ׷ӵ onlyHereonlyThereز
+    // ߶еݲͬԪأ汾ֱ׷ӵߣ졣
+    size_t diff(const MerkleTree<T, H> &, std::vector<T> &onlyHere, std::vector<T> &onlyThere) const;
+
+private:
+
+    // µķΧǿ (*lo, *hi)NULL ʾ޽硣
+    static hash_type rangeHash(node_ptr, const_ptr lo, const_ptr hi);
+    static void collect(node_ptr, const_ptr lo, const_ptr hi, std::vector<T> &);
+
+    void diffNode(node_ptr, const MerkleTree<T, H> &, const_ptr lo, const_ptr hi,
+        std::vector<T> &onlyHere, std::vector<T> &onlyThere) const;
+
+};
+
+template<class T, class H>
+typename MerkleTree<T, H>::hash_type MerkleTree<T, H>::hash() const {
+    return root == NULL ? 0 : static_cast<node_ptr>(root)->agg;
+}
+
+template<class T, class H>
+size_t MerkleTree<T, H>::diff(const MerkleTree<T, H> &o,
+    std::vector<T> &onlyHere, std::vector<T> &onlyThere) const {
+    size_t n = onlyHere.size() + onlyThere.size();
+    diffNode(static_cast<node_ptr>(root), o, NULL, NULL, onlyHere, onlyThere);
+    return onlyHere.size() + onlyThere.size() - n;
+}
+
+template<class T, class H>
+typename MerkleTree<T, H>::hash_type MerkleTree<T, H>::rangeHash
+(node_ptr r, const_ptr lo, const_ptr hi) {
+    while (r != NULL) {
+        if (lo != NULL && !(*lo < r->v))
+            r = static_cast<node_ptr>(r->child[1]);
+        else if (hi != NULL && !(r->v < *hi))
+            r = static_cast<node_ptr>(r->child[0]);
+        else
+            break;
+    }
+    if (r == NULL)
+        return 0;
+    // r ڷΧڣֻʣ½磬ұֻʣϽ磬һü롣
+    hash_type h = r->live() ? SetHash<T, H>::of(r->v) : 0;
+    for (node_ptr n = static_cast<node_ptr>(r->child[0]); n != NULL; ) {
+        if (lo != NULL && !(*lo < n->v)) {
+            n = static_cast<node_ptr>(n->child[1]);
+            continue;
+        }
+        if (n->live())
+            h += SetHash<T, H>::of(n->v);
+        if (n->child[1] != NULL)
+            h += static_cast<node_ptr>(n->child[1])->agg;
+        n = static_cast<node_ptr>(n->child[0]);
+    }
+    for (node_ptr n = static_cast<node_ptr>(r->child[1]); n != NULL; ) {
+        if (hi != NULL && !(n->v < *hi)) {
+            n = static_cast<node_ptr>(n->child[0]);
+            continue;
+        }
+        if (n->live())
+            h += SetHash<T, H>::of(n->v);
+        if (n->child[0] != NULL)
+            h += static_cast<node_ptr>(n->child[0])->agg;
+        n = static_cast<node_ptr>(n->child[1]);
+    }
+    return h;
+}
+
+template<class T, class H>
+void MerkleTree<T, H>::collect(node_ptr r, const_ptr lo, const_ptr hi, std::vector<T> &out) {
+    if (r == NULL)
+        return;
+    bool left = lo == NULL || *lo < r->v, right = hi == NULL || r->v < *hi;
+    if (left)
+        collect(static_cast<node_ptr>(r->child[0]), lo, hi, out);
+    if (left && right && r->live())
+        out.push_back(r->v);
+    if (right)
+        collect(static_cast<node_ptr>(r->child[1]), lo, hi, out);
+}
+
+/**
+ * r Ǳ (*lo, *hi) ڵȫԪء
+ */
+template<class T, class H>
+void MerkleTree<T, H>::diffNode(node_ptr r, const MerkleTree<T, H> &o, const_ptr lo, const_ptr hi,
+    std::vector<T> &onlyHere, std::vector<T> &onlyThere) const {
+    if (r == NULL) {
+        collect(static_cast<node_ptr>(o.root), lo, hi, onlyThere);
+        return;
+    }
+    if (r->agg == rangeHash(static_cast<node_ptr>(o.root), lo, hi))
+        return;
+    diffNode(static_cast<node_ptr>(r->child[0]), o, lo, &r->v, onlyHere, onlyThere);
+    const_ptr p = o.find(r->v);
+    if (r->live() && (p == NULL || H()(r->v) != H()(*p)))
+        onlyHere.push_back(r->v);
+    if (p != NULL && (!r->live() || H()(r->v) != H()(*p)))
+        onlyThere.push_back(*p);
+    diffNode(static_cast<node_ptr>(r->child[1]), o, &r->v, hi, onlyHere, onlyThere);
+}
+
+}
+}
@@ -40,8 +40,10 @@ bool NormalBST<T>::remove(const_ref t) {
     if (root == NULL)
         return false;
     Bnode_ptr del = removeFromTree(t, root);
-    delete del;
-    return del != NULL;
+    if (del == NULL)
+        return false;
+    freeNode(del);
+    return true;
 }
 
 /**
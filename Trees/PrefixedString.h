@@ -0,0 +1,62 @@
+#pragma once
+
+#include <string>
+#include "TreeHash.h"
+
+namespace sine {
+namespace tree {
+
+/**
+ * ǰ׺ַ
+ * ǰ 8 ֽڰ㲹 0ڶԪشڽڵС
+ * Ƚʱȱǰ׺ֻǰ׺ͬʱŷʶϵַ
+ * ʱ󲿷ֲ㲻ҪڶλδС
+ *  std::string ͬ
+ */
+class PrefixedString {
+
+public:
+
+    PrefixedString() : prefix(0) {}
+    PrefixedString(const std::string &s) : prefix(prefixOf(s)), s(s) {}
+    PrefixedString(const char *s) : s(s) { prefix = prefixOf(this->s); }
+
+    const std::string &str() const { return s; }
+
+    bool operator==(const PrefixedString &o) const {
+        return prefix == o.prefix && s == o.s;
+    }
+    bool operator!=(const PrefixedString &o) const {
+        return !(*this == o);
+    }
+    bool operator<(const PrefixedString &o) const {
+        if (prefix != o.prefix)
+            return prefix < o.prefix;
+        if (s.size() <= 8 || o.s.size() <= 8)  // ̵һһǰ׺
+            return s.size() < o.s.size();
+        return s.compare(8, std::string::npos, o.s, 8, std::string::npos) < 0;
+    }
+
+private:
+
+    static unsigned long long prefixOf(const std::string &s) {
+        unsigned long long p = 0;
+        for (size_t i = 0; i < 8; i++)
+            p = p << 8 | (i < s.size() ? (unsigned char)s[i] : 0);
+        return p;
+    }
+
+    unsigned long long prefix;
+    std::string s;
+
+};
+
+template<>
+struct TreeHash<PrefixedString> {
+    size_t operator()(const PrefixedString &v) const {
+        return std::hash<std::string>()(v.str());
+    }
+};
+
+}
+}
@@ -2,39 +2,80 @@
 
 #include <stdexcept>
 #include <cassert>
-#include "SelfBalancedBT.h"
+#include <vector>
+#include "FingerBT.h"
+#include "RotationCounter.h"
+#include "Augment.h"
 
 namespace sine {
 namespace tree {
 
 /**
  * 
+ * ģʽ²ֻϺҶӡɾֻǣκת
+ * µĺͻɾڵ rebalance ޸
+ * A Ϊڵչ Augment.hR Ϊת RotationCounter.h
  */
-template<class T>
-class RBTree : public SelfBalancedBT<T> {
+template<class T, class A = NoAugment, class R = NoRotationCount>
+class RBTree : public FingerBT<T> {
 
 public:
 
+    RBTree();
+
+    using FingerBT<T>::insert;
+
     virtual bool insert(const_ref);
     virtual bool remove(const_ref);
 
-    virtual bool checkBalance() const;
+    virtual ptr find(const_ref);
+    virtual const_ptr find(const_ref) const;  // ѱɾԪ
 
-private:
+    virtual bool checkBalance() const;  // ģʽ rebalance ɺų
+
+    // رʱȫ޸ģʽ±ῴδɾԪء
+    void setRelaxed(bool);
+    bool isRelaxed() const;
+    size_t rebalance(size_t budget = (size_t)-1);  // ޸ budget ʣ
+    size_t pending() const;
+
+    typename A::value_type aggregate(const_ref lo, const_ref hi) const;  // [lo, hi] ڵľۺֵ
+
+    void compact();  // ѽڵ㰴 van Emde Boas ˳ᵽһڴУ֮Կ޸
+    MemoryStats memoryStats() const;
+
+    static unsigned long long rotationCount();  // ͬһ͵ۼƵתR Ϊ NoRotationCount ʱΪ 0
+    static void resetRotationCount();
+
+protected:
+
+    virtual Bnode_ptr insertSubtree(const_ref, Bnode_ptr_ref, int &sign);
+    virtual bool propagateInsert(Bnode_ptr_ref, int i, int &sign);
+    virtual void afterInsert();
 
     class Node;
     typedef Node * node_ptr;
 
-    class Node : public BinaryNode {
+    class Node : public A::template Node<BinaryNode> {
     public:
         bool red;
+        bool dead;  // ģʽɾδ
         Node();
         Node(const_ref);
         virtual Bnode_ptr clone();
+        bool live() const;
     };
 
+private:
+
     static Bnode_ptr insertToTree(const_ref, Bnode_ptr_ref, int &sign);
+    Bnode_ptr insertRelaxed(const_ref, Bnode_ptr_ref);
+    bool repair(const_ref);
+    static node_ptr findNode(const_ref, Bnode_ptr);
+    void pullPath(const_ref);
+    static void pull(Bnode_ptr);  // ¼ڵչ
     static Bnode_ptr removeFromTree(const_ref, Bnode_ptr_ref, int &sign);
+    static bool fixInsert(Bnode_ptr_ref, int, int sign2, int &sign);  // ʱ޸Ƿת
 
     static void rotate(Bnode_ptr_ref, bool right);
     static void fixUnbalance(Bnode_ptr_ref, int, int &sign);  // ɾʱ޸
@@ -45,16 +86,35 @@ private:
     static int debugTest(node_ptr, bool fail);
     static int testAndGetBlacks(node_ptr);
 
+    bool relaxed;
+    std::vector<T> conflicts;  // ɫڵͻĺڵ
+    std::vector<T> deleted;
+
+    typedef typename R::template Counter<RBTree<T, A, R> > Rotations;
+
 };
 
 #define IS_RED(r) (r != NULL && r->red)
 
-template<class T>
-bool RBTree<T>::insert(const_ref t) {
+template<class T, class A, class R>
+RBTree<T, A, R>::RBTree()
+    : relaxed(false) {
+}
+
+template<class T, class A, class R>
+bool RBTree<T, A, R>::insert(const_ref t) {
+    dropFinger();
     if (root == NULL) {
         node_ptr newRoot = new Node(t);
         newRoot->red = false;
         root = newRoot;
+        pull(root);
+        return true;
+    }
+    if (relaxed) {
+        if (insertRelaxed(t, root) == NULL)
+            return false;
+        dynamic_cast<node_ptr>(root)->red = false;
         return true;
     }
     int unused;
@@ -64,50 +124,177 @@ bool RBTree<T>::insert(const_ref t) {
     return true;
 }
 
-template<class T>
-bool RBTree<T>::remove(const_ref t) {
+template<class T, class A, class R>
+bool RBTree<T, A, R>::remove(const_ref t) {
+    dropFinger();
+    if (relaxed) {
+        node_ptr p = findNode(t, root);
+        if (p == NULL || p->dead)
+            return false;
+        p->dead = true;
+        deleted.push_back(t);
+        pullPath(t);
+        return true;
+    }
     if (root == NULL)
         return false;
     int unused;
     Bnode_ptr p = removeFromTree(t, root, unused);
     if (root != NULL)
         dynamic_cast<node_ptr>(root)->red = false;
-    delete p;
+    freeNode(p);
     return p != NULL;
 }
 
-template<class T>
-bool RBTree<T>::checkBalance() const {
+template<class T, class A, class R>
+typename RBTree<T, A, R>::ptr RBTree<T, A, R>::find(const_ref t) {
+    node_ptr p = findNode(t, root);
+    return p == NULL || p->dead ? NULL : &p->v;
+}
+
+template<class T, class A, class R>
+typename RBTree<T, A, R>::const_ptr RBTree<T, A, R>::find(const_ref t) const {
+    node_ptr p = findNode(t, root);
+    return p == NULL || p->dead ? NULL : &p->v;
+}
+
+template<class T, class A, class R>
+bool RBTree<T, A, R>::checkBalance() const {
     return testAndGetBlacks(dynamic_cast<node_ptr>(root)) >= 0;
 }
 
-template<class T>
-RBTree<T>::Node::Node()
-    : red(true) {
+template<class T, class A, class R>
+void RBTree<T, A, R>::setRelaxed(bool r) {
+    if (!r)
+        rebalance();
+    relaxed = r;
 }
 
-template<class T>
-RBTree<T>::Node::Node(const_ref v)
-    : BinaryNode(v), red(true) {
+template<class T, class A, class R>
+bool RBTree<T, A, R>::isRelaxed() const {
+    return relaxed;
 }
 
-template<class T>
-typename RBTree<T>::Bnode_ptr RBTree<T>::Node::clone() {
+/**
+ * ޸ͻȫ޸ͨɾɾڵ㡣
+ */
+template<class T, class A, class R>
+size_t RBTree<T, A, R>::rebalance(size_t budget) {
+    dropFinger();
+    for (; budget > 0 && !conflicts.empty(); budget--) {
+        T v = conflicts.back();
+        conflicts.pop_back();
+        while (repair(v));
+    }
+    for (; budget > 0 && conflicts.empty() && !deleted.empty(); budget--) {
+        T v = deleted.back();
+        deleted.pop_back();
+        node_ptr p = findNode(v, root);
+        if (p == NULL || !p->dead)
+            continue;
+        int unused = 0;
+        freeNode(removeFromTree(v, root, unused));
+        if (root != NULL)
+            dynamic_cast<node_ptr>(root)->red = false;
+    }
+    return pending();
+}
+
+template<class T, class A, class R>
+size_t RBTree<T, A, R>::pending() const {
+    return conflicts.size() + deleted.size();
+}
+
+template<class T, class A, class R>
+typename A::value_type RBTree<T, A, R>::aggregate(const_ref lo, const_ref hi) const {
+    return A::query(static_cast<const Node *>(root), &lo, &hi);
+}
+
+template<class T, class A, class R>
+void RBTree<T, A, R>::compact() {
+    dropFinger();
+    compactAs<Node>();
+}
+
+template<class T, class A, class R>
+MemoryStats RBTree<T, A, R>::memoryStats() const {
+    return statsAs<Node>();
+}
+
+template<class T, class A, class R>
+unsigned long long RBTree<T, A, R>::rotationCount() {
+    return Rotations::count();
+}
+
+template<class T, class A, class R>
+void RBTree<T, A, R>::resetRotationCount() {
+    Rotations::reset();
+}
+
+template<class T, class A, class R>
+typename RBTree<T, A, R>::Bnode_ptr RBTree<T, A, R>::insertSubtree
+(const_ref t, Bnode_ptr_ref _r, int &sign) {
+    sign = -1;
+    if (relaxed)
+        return insertRelaxed(t, _r);
+    return insertToTree(t, _r, sign);
+}
+
+/**
+ * תΪɫһ㻹Ҫһκͻ
+ */
+template<class T, class A, class R>
+bool RBTree<T, A, R>::propagateInsert(Bnode_ptr_ref _r, int i, int &sign) {
+    if (relaxed) {
+        pull(_r);
+        return A::enabled;
+    }
+    int sign2 = sign;
+    sign = -1;
+    bool more = fixInsert(_r, i, sign2, sign) || sign != -1;
+    pull(_r);
+    return more || A::enabled;  // չʱһֱµ
+}
+
+template<class T, class A, class R>
+void RBTree<T, A, R>::afterInsert() {
+    dynamic_cast<node_ptr>(root)->red = false;
+}
+
+template<class T, class A, class R>
+RBTree<T, A, R>::Node::Node()
+    : red(true), dead(false) {
+}
+
+template<class T, class A, class R>
+RBTree<T, A, R>::Node::Node(const_ref v)
+    : A::template Node<BinaryNode>(v), red(true), dead(false) {
+}
+
+template<class T, class A, class R>
+typename RBTree<T, A, R>::Bnode_ptr RBTree<T, A, R>::Node::clone() {
     node_ptr rtn = new Node(v);
     rtn->red = red;
+    rtn->dead = dead;
     if (child[0] != NULL)
         rtn->child[0] = child[0]->clone();
     if (child[1] != NULL)
         rtn->child[1] = child[1]->clone();
+    pull(rtn);
     return rtn;
 }
 
+template<class T, class A, class R>
+bool RBTree<T, A, R>::Node::live() const {
+    return !dead;
+}
+
 /**
  * ָܿ롣
  * ź-1ʾޱ仯01ʾҽڵֳͻ͵ǰڵͬΪɫ
  */
-template<class T>
-typename RBTree<T>::Bnode_ptr RBTree<T>::insertToTree
+template<class T, class A, class R>
+typename RBTree<T, A, R>::Bnode_ptr RBTree<T, A, R>::insertToTree
 (const_ref v, Bnode_ptr_ref _r, int &sign) {
     if (v == _r->v)
         return NULL;
@@ -117,30 +304,144 @@ typename RBTree<T>::Bnode_ptr RBTree<T>::insertToTree
         _c = new Node(v);
         if (dynamic_cast<node_ptr>(_r)->red)
             sign = i;
+        pull(_c);
+        pull(_r);
         return _c;
     }
     int sign2 = -1;
     Bnode_ptr p = insertToTree(v, _c, sign2);
     if (p == NULL)
         return NULL;
+    fixInsert(_r, i, sign2, sign);
+    pull(_r);
+    return p;
+}
+
+/**
+ * ӽڵ i ź sign2޸ǰڵ㲢źš
+ */
+template<class T, class A, class R>
+bool RBTree<T, A, R>::fixInsert(Bnode_ptr_ref _r, int i, int sign2, int &sign) {
+    Bnode_ptr_ref _c = _r->child[i];
     if (sign2 != -1) {
         if (sign2 != i)
             rotate(_c, i == 1);
         dynamic_cast<node_ptr>(_c->child[i])->red = false;
         rotate(_r, i == 0);
+        return true;
     }
-    else if (dynamic_cast<node_ptr>(_r)->red &&
-             dynamic_cast<node_ptr>(_c)->red)
+    if (dynamic_cast<node_ptr>(_r)->red &&
+        dynamic_cast<node_ptr>(_c)->red)
         sign = i;
-    return p;
+    return false;
+}
+
+/**
+ * ָܿ롣
+ * ϺҶӣתڵΪʱ³ͻѱɾͬԪֱӻָ
+ */
+template<class T, class A, class R>
+typename RBTree<T, A, R>::Bnode_ptr RBTree<T, A, R>::insertRelaxed(const_ref v, Bnode_ptr_ref _r) {
+    std::vector<Bnode_ptr> path;
+    Bnode_ptr *slot = &_r;
+    node_ptr parent = NULL;
+    Bnode_ptr rtn = NULL;
+    while (*slot != NULL) {
+        node_ptr r = dynamic_cast<node_ptr>(*slot);
+        path.push_back(r);
+        if (v == r->v) {
+            if (!r->dead)
+                return NULL;
+            r->v = v;
+            r->dead = false;
+            rtn = r;
+            break;
+        }
+        parent = r;
+        slot = &r->child[v < r->v ? 0 : 1];
+    }
+    if (rtn == NULL) {
+        rtn = *slot = new Node(v);
+        path.push_back(rtn);
+        if (IS_RED(parent))
+            conflicts.push_back(v);
+    }
+    if (A::enabled)
+        for (size_t i = path.size(); i-- > 0; )
+            pull(path[i]);
+    return rtn;
+}
+
+/**
+ * ޸ v ·ϵһͻϵ游ڵΪڣ
+ * ޸ʱͬϼ顣ûгͻʱ false
+ */
+template<class T, class A, class R>
+bool RBTree<T, A, R>::repair(const_ref v) {
+    std::vector<Bnode_ptr *> slot(1, &root);
+    std::vector<int> dir;
+    size_t top = 0;
+    for (Bnode_ptr r = root; r != NULL && !(v == r->v); ) {
+        int i = v < r->v ? 0 : 1;
+        Bnode_ptr c = r->child[i];
+        if (c == NULL)
+            break;
+        dir.push_back(i);
+        slot.push_back(&r->child[i]);
+        if (dynamic_cast<node_ptr>(r)->red && dynamic_cast<node_ptr>(c)->red) {
+            top = slot.size() - 2;  // ͻиڵڲ
+            break;
+        }
+        r = c;
+    }
+    if (top == 0)
+        return false;
+    int sign = -1;
+    fixInsert(*slot[top - 1], dir[top - 1], dir[top], sign);
+    for (size_t k = top - 1; k > 0; k--) {
+        int sign2 = sign;
+        sign = -1;
+        if (!fixInsert(*slot[k - 1], dir[k - 1], sign2, sign) && sign == -1)
+            break;
+    }
+    dynamic_cast<node_ptr>(root)->red = false;
+    return true;
+}
+
+template<class T, class A, class R>
+typename RBTree<T, A, R>::node_ptr RBTree<T, A, R>::findNode(const_ref v, Bnode_ptr r) {
+    while (r != NULL && !(v == r->v))
+        r = r->child[v < r->v ? 0 : 1];
+    return dynamic_cast<node_ptr>(r);
+}
+
+// ¶¼㵽 v ·ϵչݡ
+template<class T, class A, class R>
+void RBTree<T, A, R>::pullPath(const_ref v) {
+    if (!A::enabled)
+        return;
+    std::vector<Bnode_ptr> path;
+    for (Bnode_ptr r = root; r != NULL; r = r->child[v < r->v ? 0 : 1]) {
+        path.push_back(r);
+        if (v == r->v)
+            break;
+    }
+    for (size_t i = path.size(); i-- > 0; )
+        pull(path[i]);
+}
+
+template<class T, class A, class R>
+void RBTree<T, A, R>::pull(Bnode_ptr r) {
+    if (r != NULL)
+        A::pull(static_cast<node_ptr>(r));
 }
 
 /**
  * ָܿ롣
  * ź1ʾڽڵ1ź0ʾޱ仯
  */
-template<class T>
-typename RBTree<T>::Bnode_ptr RBTree<T>::removeFromTree
+template<class T, class A, class R>
+typename RBTree<T, A, R>::Bnode_ptr RBTree<T, A, R>::removeFromTree
 (const_ref v, Bnode_ptr_ref _r, int &sign) {
     Bnode_ptr rtn = _r;
     int sign2 = 0;
@@ -163,6 +464,7 @@ typename RBTree<T>::Bnode_ptr RBTree<T>::removeFromTree
                 sign = 1;
             _r = NULL;
         }
+        pull(_r);
         rtn->child[0] = NULL;
         rtn->child[1] = NULL;
         return rtn;
@@ -177,21 +479,25 @@ typename RBTree<T>::Bnode_ptr RBTree<T>::removeFromTree
         return NULL;
     if (sign2 == 1)  // ӽڵĺڽڵ1
         fixUnbalance(_r, i, sign);
+    pull(_r);
     return rtn;
 }
 
-template<class T>
-void RBTree<T>::rotate(Bnode_ptr_ref _r, bool right) {
+template<class T, class A, class R>
+void RBTree<T, A, R>::rotate(Bnode_ptr_ref _r, bool right) {
     int i = right ? 1 : 0;
     Bnode_ptr _c = _r->child[1 - i];
     _r->child[1 - i] = _c->child[i];
     _c->child[i] = _r;
     _r = _c;
+    pull(_c->child[i]);
+    pull(_c);
+    Rotations::add();
 }
 
 // ޸iϺڽڵ1µĲƽ⡣
-template<class T>
-void RBTree<T>::fixUnbalance(Bnode_ptr_ref _r, int i, int &sign) {
+template<class T, class A, class R>
+void RBTree<T, A, R>::fixUnbalance(Bnode_ptr_ref _r, int i, int &sign) {
     // ʱĬiΪ1
     Bnode_ptr_ref _other = _r->child[1 - i];
     node_ptr r = dynamic_cast<node_ptr>(_r);
@@ -233,8 +539,8 @@ void RBTree<T>::fixUnbalance(Bnode_ptr_ref _r, int i, int &sign) {
     }
 }
 
-template<class T>
-typename RBTree<T>::Bnode_ptr RBTree<T>::pickMaxAndFix
+template<class T, class A, class R>
+typename RBTree<T, A, R>::Bnode_ptr RBTree<T, A, R>::pickMaxAndFix
 (Bnode_ptr_ref _r, int &sign) {
     Bnode_ptr rtn = _r;
     int sign2 = 0;
@@ -253,12 +559,13 @@ typename RBTree<T>::Bnode_ptr RBTree<T>::pickMaxAndFix
     rtn = pickMaxAndFix(_r->child[1], sign2);
     if (sign2 == 1)  // ӽڵĺڽڵ1
         fixUnbalance(_r, 1, sign);
+    pull(_r);
     return rtn;
 }
 
 // ɾʱƽڵΪ
-template<class T>
-void RBTree<T>::fixRedBlack(Bnode_ptr_ref _r, int i) {
+template<class T, class A, class R>
+void RBTree<T, A, R>::fixRedBlack(Bnode_ptr_ref _r, int i) {
     Bnode_ptr_ref _other = _r->child[1 - i];
     node_ptr a = dynamic_cast<node_ptr>(_other->child[1 - i]);
     node_ptr b = dynamic_cast<node_ptr>(_other->child[i]);
@@ -277,8 +584,8 @@ void RBTree<T>::fixRedBlack(Bnode_ptr_ref _r, int i) {
     rotate(_r, i == 1);
 }
 
-template<class T>
-int RBTree<T>::debugTest(node_ptr p, bool fail) {
+template<class T, class A, class R>
+int RBTree<T, A, R>::debugTest(node_ptr p, bool fail) {
     int rtn = testAndGetBlacks(p);
     if (fail ^ (rtn >= 0)) {
         int unused = 0;
@@ -286,8 +593,8 @@ int RBTree<T>::debugTest(node_ptr p, bool fail) {
     return rtn;
 }
 
-template<class T>
-int RBTree<T>::testAndGetBlacks(node_ptr r) {
+template<class T, class A, class R>
+int RBTree<T, A, R>::testAndGetBlacks(node_ptr r) {
     if (r == NULL)
         return 0;
     node_ptr c0 = dynamic_cast<node_ptr>(r->child[0]);
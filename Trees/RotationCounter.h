@@ -0,0 +1,42 @@
+#pragma once
+
+#include <atomic>
+
+namespace sine {
+namespace tree {
+
+/**
+ * תΪ RBTree/AVLTree/WAVLTree ĵģֻڲԡ
+ * NoRotationCount ʲôҲcount Ϊ 0
+ * CountRotations ͬһ͵һԭӼ
+ * ڲͬ߳޸ĵͬ ShardedTree ĸƬڵĻС
+ * Ƿ;꣬뵥ԪĶһµġ
+ */
+struct NoRotationCount {
+
+    template<class Tree>
+    struct Counter {
+        static void add() {}
+        static unsigned long long count() { return 0; }
+        static void reset() {}
+    };
+
+};
+
+struct CountRotations {
+
+    template<class Tree>
+    struct Counter {
+        static void add() { n.fetch_add(1, std::memory_order_relaxed); }
+        static unsigned long long count() { return n; }
+        static void reset() { n = 0; }
+        static std::atomic<unsigned long long> n;
+    };
+
+};
+
+template<class Tree>
+std::atomic<unsigned long long> CountRotations::Counter<Tree>::n(0);
+
+}
+}
@@ -0,0 +1,229 @@
+#pragma once
+
+#include <cmath>
+#include <vector>
+#include <algorithm>
+#include <functional>
+#include "SelfBalancedBT.h"
+
+namespace sine {
+namespace tree {
+
+/**
+ * 
+ * ڵͨ BinaryNodeκƽϢ
+ * ʱؽɾʱؽ̯ O(log n)
+ * ؽԭнڵ㲢ַ˳Уʹؽڴʡ
+ * ؽԪڵĽڵ仯find صָһ޸ĺʧЧ
+ */
+template<class T>
+class ScapegoatTree : public SelfBalancedBT<T> {
+
+public:
+
+    ScapegoatTree(double alpha = 0.7);  // alpha ȡ (0.5, 1)
+
+    virtual bool insert(const_ref);
+    virtual bool remove(const_ref);
+
+    virtual bool checkBalance() const;
+
+private:
+
+    static Bnode_ptr insertToTree
+        (const_ref, Bnode_ptr_ref, int depth, int limit, double alpha, int &sign);
+    static Bnode_ptr removeFromTree(const_ref, Bnode_ptr_ref);
+    static Bnode_ptr pickMax(Bnode_ptr_ref);
+
+    static void rebuild(Bnode_ptr_ref, int size);
+    static void flatten(Bnode_ptr, std::vector<Bnode_ptr> &, std::vector<T> &);
+    static Bnode_ptr build
+        (std::vector<Bnode_ptr> &, std::vector<T> &, int lo, int hi, int &next);
+
+    static int count(Bnode_ptr);
+    static int height(Bnode_ptr);
+    int heightLimit(int) const;
+
+    double alpha;
+    int size, maxSize;
+
+};
+
+template<class T>
+ScapegoatTree<T>::ScapegoatTree(double alpha)
+    : alpha(alpha), size(0), maxSize(0) {
+}
+
+template<class T>
+bool ScapegoatTree<T>::insert(const_ref t) {
+    if (root == NULL) {
+        root = new BinaryNode(t);
+        size = maxSize = 1;
+        return true;
+    }
+    int sign = 0;
+    if (insertToTree(t, root, 0, heightLimit(size + 1), alpha, sign) == NULL)
+        return false;
+    if (++size > maxSize)
+        maxSize = size;
+    return true;
+}
+
+template<class T>
+bool ScapegoatTree<T>::remove(const_ref t) {
+    if (root == NULL)
+        return false;
+    Bnode_ptr del = removeFromTree(t, root);
+    if (del == NULL)
+        return false;
+    freeNode(del);
+    if (--size < alpha * maxSize) {
+        rebuild(root, size);
+        maxSize = size;
+    }
+    return true;
+}
+
+template<class T>
+bool ScapegoatTree<T>::checkBalance() const {
+    return count(root) == size && height(root) <= heightLimit(maxSize);
+}
+
+/**
+ * ָܿ롣
+ * ½ڵȳ limit ʱsign Ϊݵǰڵ
+ * ҵؽΪ 0
+ */
+template<class T>
+typename ScapegoatTree<T>::Bnode_ptr ScapegoatTree<T>::insertToTree
+(const_ref v, Bnode_ptr_ref _r, int depth, int limit, double alpha, int &sign) {
+    if (v == _r->v)
+        return NULL;
+    int i = v < _r->v ? 0 : 1;
+    Bnode_ptr_ref _c = _r->child[i];
+    Bnode_ptr p;
+    int sign2 = 0;
+    if (_c == NULL) {
+        p = _c = new BinaryNode(v);
+        if (depth + 1 > limit)
+            sign2 = 1;
+    }
+    else {
+        p = insertToTree(v, _c, depth + 1, limit, alpha, sign2);
+        if (p == NULL)
+            return NULL;
+    }
+    if (sign2 > 0) {
+        int s = sign2 + count(_r->child[1 - i]) + 1;
+        if (sign2 > alpha * s)  // ǰڵ
+            rebuild(_r, s);
+        else
+            sign = s;
+    }
+    return p;
+}
+
+/**
+ * ָܿ롣
+ */
+template<class T>
+typename ScapegoatTree<T>::Bnode_ptr ScapegoatTree<T>::removeFromTree
+(const_ref v, Bnode_ptr_ref _r) {
+    Bnode_ptr rtn = _r;
+    if (v == _r->v) {  // ҵǰڵ㡣
+        if (_r->child[0] != NULL) {  // ȡֵ滻
+            _r = pickMax(rtn->child[0]);
+            _r->child[0] = rtn->child[0];
+            _r->child[1] = rtn->child[1];
+        }
+        else {
+            _r = rtn->child[1];
+        }
+        rtn->child[0] = NULL;
+        rtn->child[1] = NULL;
+        return rtn;
+    }
+    Bnode_ptr_ref _c = _r->child[v < _r->v ? 0 : 1];
+    if (_c == NULL)
+        return NULL;
+    return removeFromTree(v, _c);
+}
+
+/**
+ * ָܿ롣
+ */
+template<class T>
+typename ScapegoatTree<T>::Bnode_ptr ScapegoatTree<T>::pickMax(Bnode_ptr_ref _r) {
+    if (_r->child[1] != NULL)
+        return pickMax(_r->child[1]);
+    Bnode_ptr rtn = _r;
+    _r = rtn->child[0];
+    return rtn;
+}
+
+/**
+ *  _r ؽΪȫƽ
+ * ڵ㰴ַȡãֵ롣
+ */
+template<class T>
+void ScapegoatTree<T>::rebuild(Bnode_ptr_ref _r, int size) {
+    std::vector<Bnode_ptr> nodes;
+    std::vector<T> values;
+    nodes.reserve(size);
+    values.reserve(size);
+    flatten(_r, nodes, values);
+    std::sort(nodes.begin(), nodes.end(), std::less<Bnode_ptr>());
+    int next = 0;
+    _r = build(nodes, values, 0, (int)values.size(), next);
+}
+
+template<class T>
+void ScapegoatTree<T>::flatten
+(Bnode_ptr r, std::vector<Bnode_ptr> &nodes, std::vector<T> &values) {
+    if (r == NULL)
+        return;
+    flatten(r->child[0], nodes, values);
+    nodes.push_back(r);
+    values.push_back(r->v);
+    flatten(r->child[1], nodes, values);
+}
+
+template<class T>
+typename ScapegoatTree<T>::Bnode_ptr ScapegoatTree<T>::build
+(std::vector<Bnode_ptr> &nodes, std::vector<T> &values, int lo, int hi, int &next) {
+    if (lo >= hi)
+        return NULL;
+    int mid = (lo + hi) / 2;
+    Bnode_ptr r = nodes[next++];
+    r->v = values[mid];
+    r->child[0] = build(nodes, values, lo, mid, next);
+    r->child[1] = build(nodes, values, mid + 1, hi, next);
+    return r;
+}
+
+template<class T>
+int ScapegoatTree<T>::count(Bnode_ptr r) {
+    if (r == NULL)
+        return 0;
+    return count(r->child[0]) + count(r->child[1]) + 1;
+}
+
+// ԱƵĸ߶ȣΪ -1
+template<class T>
+int ScapegoatTree<T>::height(Bnode_ptr r) {
+    if (r == NULL)
+        return -1;
+    int h0 = height(r->child[0]), h1 = height(r->child[1]);
+    return (h0 > h1 ? h0 : h1) + 1;
+}
+
+//  log(n) / log(1 / alpha)
+template<class T>
+int ScapegoatTree<T>::heightLimit(int n) const {
+    if (n <= 1)
+        return 0;
+    return (int)std::floor(std::log((double)n) / std::log(1 / alpha));
+}
+
+}
+}
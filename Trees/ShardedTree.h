@@ -0,0 +1,314 @@
+#pragma once
+
+#include <vector>
+#include <algorithm>
+#include <mutex>
+#include "RBTree.h"
+#include "TreeHash.h"
+#include "ThreadPool.h"
+#include "CacheAligned.h"
+
+namespace sine {
+namespace tree {
+
+/**
+ * Ƭ
+ * ΧɢаԪطֵ N öEngineǶУÿƬһ
+ * ֻӦķƬȰƬ飬ÿƬһ񽻸̳߳زִС
+ * ΧƬʱָ s[0] < s[1] < ... Ԫطֵ (-inf, s[0]), [s[0], s[1]), ...
+ * find صָڸԪرɾ֮ǰЧ
+ */
+template<class T, class Engine = RBTree<T>, class H = TreeHash<T> >
+class ShardedTree : public virtual SearchTree<T> {
+
+public:
+
+    explicit ShardedTree(size_t shards = 16);  // ɢзƬ
+    explicit ShardedTree(const std::vector<T> &splitters);  // ΧƬ
+    ShardedTree(const ShardedTree<T, Engine, H> &);
+    virtual ~ShardedTree();
+
+    virtual bool insert(const_ref);
+    virtual bool remove(const_ref);
+
+    virtual ptr find(const_ref);
+    virtual const_ptr find(const_ref) const;
+
+    virtual bool checkValid() const;
+
+    // سɹ루ɾĸ
+    size_t insertAll(const std::vector<T> &, ThreadPool &pool = ThreadPool::global());
+    size_t removeAll(const std::vector<T> &, ThreadPool &pool = ThreadPool::global());
+
+    size_t shardCount() const;
+    size_t shardOf(const_ref) const;
+
+    class const_iterator;  // ȫԪذ򣬱ڼ䲻в޸
+
+    const_iterator begin() const;
+    const_iterator end() const;
+
+private:
+
+    class Shard : public CacheAligned {
+    public:
+        std::mutex lock;
+        Engine tree;
+        Shard() {}
+        Shard(const Shard &o) : tree(o.tree) {}
+    };
+
+    template<bool ins>
+    size_t applyAll(const std::vector<T> &, ThreadPool &);
+
+    template<bool ins>
+    static void applyShard(Shard *, const std::vector<const T *> *, size_t *count);
+
+    template<bool ins>
+    class ShardTask : public ThreadPool::Task {
+    public:
+        ShardTask(Shard *s, const std::vector<const T *> *group, size_t *count)
+            : s(s), group(group), count(count) {}
+        virtual void run() { applyShard<ins>(s, group, count); }
+    private:
+        Shard *s;
+        const std::vector<const T *> *group;
+        size_t *count;
+    };
+
+    std::vector<Shard *> shards;
+    std::vector<T> splitters;
+    bool ranged;
+
+public:
+
+    class const_iterator {
+    public:
+        const_ref operator*() const;
+        const_ptr operator->() const;
+        const_iterator &operator++();
+        bool operator==(const const_iterator &) const;
+        bool operator!=(const const_iterator &) const;
+    private:
+        friend class ShardedTree<T, Engine, H>;
+        typedef typename Engine::const_iterator Cursor;
+        void pick();
+        std::vector<Cursor> cur, last;
+        size_t at;  // ǰڷƬcur.size() ʾ
+        bool ranged;
+    };
+
+};
+
+template<class T, class Engine, class H>
+ShardedTree<T, Engine, H>::ShardedTree(size_t n)
+    : ranged(false) {
+    if (n < 1)
+        n = 1;
+    for (size_t i = 0; i < n; i++)
+        shards.push_back(new Shard());
+}
+
+template<class T, class Engine, class H>
+ShardedTree<T, Engine, H>::ShardedTree(const std::vector<T> &s)
+    : splitters(s), ranged(true) {
+    for (size_t i = 0; i <= s.size(); i++)
+        shards.push_back(new Shard());
+}
+
+template<class T, class Engine, class H>
+ShardedTree<T, Engine, H>::ShardedTree(const ShardedTree<T, Engine, H> &o)
+    : splitters(o.splitters), ranged(o.ranged) {
+    for (size_t i = 0; i < o.shards.size(); i++) {
+        std::lock_guard<std::mutex> g(o.shards[i]->lock);
+        shards.push_back(new Shard(*o.shards[i]));
+    }
+}
+
+template<class T, class Engine, class H>
+ShardedTree<T, Engine, H>::~ShardedTree() {
+    for (size_t i = 0; i < shards.size(); i++)
+        delete shards[i];
+}
+
+template<class T, class Engine, class H>
+bool ShardedTree<T, Engine, H>::insert(const_ref t) {
+    Shard *s = shards[shardOf(t)];
+    std::lock_guard<std::mutex> g(s->lock);
+    return s->tree.insert(t);
+}
+
+template<class T, class Engine, class H>
+bool ShardedTree<T, Engine, H>::remove(const_ref t) {
+    Shard *s = shards[shardOf(t)];
+    std::lock_guard<std::mutex> g(s->lock);
+    return s->tree.remove(t);
+}
+
+template<class T, class Engine, class H>
+typename ShardedTree<T, Engine, H>::ptr ShardedTree<T, Engine, H>::find(const_ref t) {
+    Shard *s = shards[shardOf(t)];
+    std::lock_guard<std::mutex> g(s->lock);
+    return s->tree.find(t);
+}
+
+template<class T, class Engine, class H>
+typename ShardedTree<T, Engine, H>::const_ptr ShardedTree<T, Engine, H>::find
+(const_ref t) const {
+    Shard *s = shards[shardOf(t)];
+    std::lock_guard<std::mutex> g(s->lock);
+    return s->tree.find(t);
+}
+
+/**
+ * ƬȷÿԪضԼķƬС
+ */
+template<class T, class Engine, class H>
+bool ShardedTree<T, Engine, H>::checkValid() const {
+    for (size_t i = 0; i < shards.size(); i++) {
+        std::lock_guard<std::mutex> g(shards[i]->lock);
+        const Engine &t = shards[i]->tree;
+        if (!t.checkValid())
+            return false;
+        for (typename Engine::const_iterator j = t.begin(); j != t.end(); ++j)
+            if (shardOf(*j) != i)
+                return false;
+    }
+    return true;
+}
+
+template<class T, class Engine, class H>
+size_t ShardedTree<T, Engine, H>::insertAll(const std::vector<T> &v, ThreadPool &pool) {
+    return applyAll<true>(v, pool);
+}
+
+template<class T, class Engine, class H>
+size_t ShardedTree<T, Engine, H>::removeAll(const std::vector<T> &v, ThreadPool &pool) {
+    return applyAll<false>(v, pool);
+}
+
+template<class T, class Engine, class H>
+size_t ShardedTree<T, Engine, H>::shardCount() const {
+    return shards.size();
+}
+
+template<class T, class Engine, class H>
+size_t ShardedTree<T, Engine, H>::shardOf(const_ref t) const {
+    if (ranged)
+        return std::upper_bound(splitters.begin(), splitters.end(), t) - splitters.begin();
+    return (size_t)(((mixHash(H()(t)) >> 32) * shards.size()) >> 32);
+}
+
+template<class T, class Engine, class H>
+typename ShardedTree<T, Engine, H>::const_iterator ShardedTree<T, Engine, H>::begin() const {
+    const_iterator rtn;
+    rtn.ranged = ranged;
+    for (size_t i = 0; i < shards.size(); i++) {
+        rtn.cur.push_back(shards[i]->tree.begin());
+        rtn.last.push_back(shards[i]->tree.end());
+    }
+    rtn.at = 0;
+    rtn.pick();
+    return rtn;
+}
+
+template<class T, class Engine, class H>
+typename ShardedTree<T, Engine, H>::const_iterator ShardedTree<T, Engine, H>::end() const {
+    const_iterator rtn;
+    rtn.ranged = ranged;
+    rtn.at = 0;
+    return rtn;
+}
+
+/**
+ * ƬÿǿշƬһֻһ
+ */
+template<class T, class Engine, class H>
+template<bool ins>
+size_t ShardedTree<T, Engine, H>::applyAll(const std::vector<T> &v, ThreadPool &pool) {
+    std::vector<std::vector<const T *> > groups(shards.size());
+    for (size_t i = 0; i < v.size(); i++)
+        groups[shardOf(v[i])].push_back(&v[i]);
+    std::vector<size_t> counts(shards.size(), 0);
+    ThreadPool::TaskGroup g;
+    size_t mine = shards.size();
+    for (size_t i = 0; i < shards.size(); i++) {
+        if (groups[i].empty())
+            continue;
+        if (mine == shards.size())
+            mine = i;  // һƬڵǰִ߳
+        else
+            pool.spawn(new ShardTask<ins>(shards[i], &groups[i], &counts[i]), g);
+    }
+    if (mine != shards.size())
+        applyShard<ins>(shards[mine], &groups[mine], &counts[mine]);
+    pool.wait(g);
+    size_t rtn = 0;
+    for (size_t i = 0; i < counts.size(); i++)
+        rtn += counts[i];
+    return rtn;
+}
+
+template<class T, class Engine, class H>
+template<bool ins>
+void ShardedTree<T, Engine, H>::applyShard
+(Shard *s, const std::vector<const T *> *group, size_t *count) {
+    std::lock_guard<std::mutex> g(s->lock);
+    size_t n = 0;
+    for (size_t i = 0; i < group->size(); i++)
+        if (ins ? s->tree.insert(*(*group)[i]) : s->tree.remove(*(*group)[i]))
+            n++;
+    *count = n;
+}
+
+template<class T, class Engine, class H>
+typename ShardedTree<T, Engine, H>::const_ref
+ShardedTree<T, Engine, H>::const_iterator::operator*() const {
+    return *cur[at];
+}
+
+template<class T, class Engine, class H>
+typename ShardedTree<T, Engine, H>::const_ptr
+ShardedTree<T, Engine, H>::const_iterator::operator->() const {
+    return &*cur[at];
+}
+
+template<class T, class Engine, class H>
+typename ShardedTree<T, Engine, H>::const_iterator &
+ShardedTree<T, Engine, H>::const_iterator::operator++() {
+    ++cur[at];
+    pick();
+    return *this;
+}
+
+template<class T, class Engine, class H>
+bool ShardedTree<T, Engine, H>::const_iterator::operator==(const const_iterator &o) const {
+    bool done = at == cur.size(), odone = o.at == o.cur.size();
+    if (done || odone)
+        return done && odone;
+    return &**this == &*o;
+}
+
+template<class T, class Engine, class H>
+bool ShardedTree<T, Engine, H>::const_iterator::operator!=(const const_iterator &o) const {
+    return !(*this == o);
+}
+
+/**
+ * ΧƬʱӸƬɢзƬʱȡƬǰԪСģk ·鲢
+ */
+template<class T, class Engine, class H>
+void ShardedTree<T, Engine, H>::const_iterator::pick() {
+    if (ranged) {
+        while (at < cur.size() && cur[at] == last[at])
+            at++;
+        return;
+    }
+    at = cur.size();
+    for (size_t i = 0; i < cur.size(); i++)
+        if (cur[i] != last[i] && (at == cur.size() || *cur[i] < *cur[at]))
+            at = i;
+}
+
+}
+}
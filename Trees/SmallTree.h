@@ -0,0 +1,223 @@
+#pragma once
+
+#include <new>
+#include "RBTree.h"
+
+namespace sine {
+namespace tree {
+
+/**
+ * СŻ
+ * Ԫز N ʱڶڵУԲңκνڵ㣻
+ *  N ʱת EngineǴ const_iterator Ķ
+ * ɾ N / 2 ʱת飬ڱ߽Ϸת
+ */
+template<class T, size_t N = 8, class Engine = RBTree<T> >
+class SmallTree : public virtual SearchTree<T> {
+
+public:
+
+    SmallTree();
+    SmallTree(const SmallTree<T, N, Engine> &);
+    SmallTree<T, N, Engine> &operator=(const SmallTree<T, N, Engine> &);
+    virtual ~SmallTree();
+
+    virtual bool insert(const_ref);
+    virtual bool remove(const_ref);
+
+    virtual ptr find(const_ref);
+    virtual const_ptr find(const_ref) const;
+
+    virtual bool checkValid() const;
+
+    size_t size() const;
+    bool isSmall() const;  // ǰǷʹ
+
+private:
+
+    T *items();
+    const T *items() const;
+
+    size_t lowerBound(const_ref) const;  // һСڲλ
+    void promote();
+    void demote();
+    void clear();
+    void copy(const SmallTree<T, N, Engine> &);
+
+    alignas(T) unsigned char buf[N * sizeof(T)];
+    size_t count;
+    Engine *tree;  // ʹʱΪ NULL
+
+};
+
+template<class T, size_t N, class Engine>
+SmallTree<T, N, Engine>::SmallTree()
+    : count(0), tree(NULL) {
+}
+
+template<class T, size_t N, class Engine>
+SmallTree<T, N, Engine>::SmallTree(const SmallTree<T, N, Engine> &o)
+    : count(0), tree(NULL) {
+    copy(o);
+}
+
+template<class T, size_t N, class Engine>
+SmallTree<T, N, Engine> &SmallTree<T, N, Engine>::operator=(const SmallTree<T, N, Engine> &o) {
+    if (this != &o) {
+        clear();
+        copy(o);
+    }
+    return *this;
+}
+
+template<class T, size_t N, class Engine>
+SmallTree<T, N, Engine>::~SmallTree() {
+    clear();
+}
+
+template<class T, size_t N, class Engine>
+bool SmallTree<T, N, Engine>::insert(const_ref t) {
+    if (tree == NULL) {
+        T *a = items();
+        size_t i = lowerBound(t);
+        if (i < count && a[i] == t)
+            return false;
+        if (count < N) {
+            if (i == count) {
+                new (a + count) T(t);
+            }
+            else {
+                new (a + count) T(a[count - 1]);
+                for (size_t j = count - 1; j > i; j--)
+                    a[j] = a[j - 1];
+                a[i] = t;
+            }
+            count++;
+            return true;
+        }
+        promote();
+    }
+    if (!tree->insert(t))
+        return false;
+    count++;
+    return true;
+}
+
+template<class T, size_t N, class Engine>
+bool SmallTree<T, N, Engine>::remove(const_ref t) {
+    if (tree != NULL) {
+        if (!tree->remove(t))
+            return false;
+        if (--count < N / 2)
+            demote();
+        return true;
+    }
+    T *a = items();
+    size_t i = lowerBound(t);
+    if (i == count || !(a[i] == t))
+        return false;
+    for (size_t j = i + 1; j < count; j++)
+        a[j - 1] = a[j];
+    a[--count].~T();
+    return true;
+}
+
+template<class T, size_t N, class Engine>
+typename SmallTree<T, N, Engine>::ptr SmallTree<T, N, Engine>::find(const_ref t) {
+    return const_cast<ptr>(static_cast<const SmallTree<T, N, Engine> *>(this)->find(t));
+}
+
+template<class T, size_t N, class Engine>
+typename SmallTree<T, N, Engine>::const_ptr SmallTree<T, N, Engine>::find(const_ref t) const {
+    if (tree != NULL)
+        return static_cast<const Engine *>(tree)->find(t);
+    size_t i = lowerBound(t);
+    return i < count && items()[i] == t ? items() + i : NULL;
+}
+
+template<class T, size_t N, class Engine>
+bool SmallTree<T, N, Engine>::checkValid() const {
+    if (tree != NULL)
+        return tree->checkValid();
+    if (count > N)
+        return false;
+    for (size_t i = 1; i < count; i++)
+        if (!(items()[i - 1] < items()[i]))
+            return false;
+    return true;
+}
+
+template<class T, size_t N, class Engine>
+size_t SmallTree<T, N, Engine>::size() const {
+    return count;
+}
+
+template<class T, size_t N, class Engine>
+bool SmallTree<T, N, Engine>::isSmall() const {
+    return tree == NULL;
+}
+
+template<class T, size_t N, class Engine>
+T *SmallTree<T, N, Engine>::items() {
+    return reinterpret_cast<T *>(buf);
+}
+
+template<class T, size_t N, class Engine>
+const T *SmallTree<T, N, Engine>::items() const {
+    return reinterpret_cast<const T *>(buf);
+}
+
+template<class T, size_t N, class Engine>
+size_t SmallTree<T, N, Engine>::lowerBound(const_ref t) const {
+    const T *a = items();
+    size_t i = 0;
+    while (i < count && a[i] < t)
+        i++;
+    return i;
+}
+
+template<class T, size_t N, class Engine>
+void SmallTree<T, N, Engine>::promote() {
+    tree = new Engine();
+    T *a = items();
+    for (size_t i = 0; i < count; i++) {
+        tree->insert(a[i]);
+        a[i].~T();
+    }
+}
+
+template<class T, size_t N, class Engine>
+void SmallTree<T, N, Engine>::demote() {
+    T *a = items();
+    size_t i = 0;
+    for (typename Engine::const_iterator j = tree->begin(); j != tree->end(); ++j)
+        new (a + i++) T(*j);
+    delete tree;
+    tree = NULL;
+}
+
+template<class T, size_t N, class Engine>
+void SmallTree<T, N, Engine>::clear() {
+    if (tree != NULL) {
+        delete tree;
+        tree = NULL;
+    }
+    else {
+        for (size_t i = 0; i < count; i++)
+            items()[i].~T();
+    }
+    count = 0;
+}
+
+template<class T, size_t N, class Engine>
+void SmallTree<T, N, Engine>::copy(const SmallTree<T, N, Engine> &o) {
+    if (o.tree != NULL)
+        tree = new Engine(*o.tree);
+    else
+        for (size_t i = 0; i < o.count; i++)
+            new (items() + i) T(o.items()[i]);
+    count = o.count;
+}
+
+}
+}
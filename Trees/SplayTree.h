@@ -0,0 +1,144 @@
+#pragma once
+
+#include "BinarySearchTree.h"
+
+namespace sine {
+namespace tree {
+
+/**
+ * չԶչ
+ * ƵĽڵڸʺϷʷֲбĳ
+ * period  1 ʱfind ÿ period βչһΣԼٶд롣
+ */
+template<class T>
+class SplayTree : public virtual BinarySearchTree<T> {
+
+public:
+
+    SplayTree(unsigned period = 1);
+
+    virtual bool insert(const_ref);
+    virtual bool remove(const_ref);
+
+    virtual ptr find(const_ref);
+    virtual const_ptr find(const_ref) const;  // չ
+
+    void setSplayPeriod(unsigned);
+
+private:
+
+    static void splay(const_ref, Bnode_ptr_ref);
+
+    unsigned period, accessCount;
+
+};
+
+template<class T>
+SplayTree<T>::SplayTree(unsigned period)
+    : period(period == 0 ? 1 : period), accessCount(0) {
+}
+
+template<class T>
+bool SplayTree<T>::insert(const_ref t) {
+    if (root == NULL) {
+        root = new BinaryNode(t);
+        return true;
+    }
+    splay(t, root);
+    if (t == root->v)
+        return false;
+    int i = t < root->v ? 0 : 1;
+    Bnode_ptr n = new BinaryNode(t);
+    n->child[i] = root->child[i];
+    n->child[1 - i] = root;
+    root->child[i] = NULL;
+    root = n;
+    return true;
+}
+
+template<class T>
+bool SplayTree<T>::remove(const_ref t) {
+    if (root == NULL)
+        return false;
+    splay(t, root);
+    if (!(t == root->v))
+        return false;
+    Bnode_ptr del = root;
+    if (root->child[0] == NULL) {
+        root = root->child[1];
+    }
+    else {  // ֵչΪա
+        Bnode_ptr right = root->child[1];
+        root = root->child[0];
+        splay(t, root);
+        root->child[1] = right;
+    }
+    del->child[0] = NULL;
+    del->child[1] = NULL;
+    freeNode(del);
+    return true;
+}
+
+template<class T>
+typename SplayTree<T>::ptr SplayTree<T>::find(const_ref r) {
+    if (root == NULL)
+        return NULL;
+    if (++accessCount < period)
+        return BinarySearchTree<T>::find(r);
+    accessCount = 0;
+    splay(r, root);
+    return r == root->v ? &root->v : NULL;
+}
+
+template<class T>
+typename SplayTree<T>::const_ptr SplayTree<T>::find(const_ref r) const {
+    return BinarySearchTree<T>::find(r);
+}
+
+template<class T>
+void SplayTree<T>::setSplayPeriod(unsigned p) {
+    period = p == 0 ? 1 : p;
+    accessCount = 0;
+}
+
+/**
+ * ָܿ롣
+ * ʵĽڵ㣨v ǰ̣չ _r
+ * ùҽӵָƴӣҪڱڵ㣨T һĬϹ죩
+ */
+template<class T>
+void SplayTree<T>::splay(const_ref v, Bnode_ptr_ref _r) {
+    Bnode_ptr l = NULL, r = NULL;  // 
+    Bnode_ptr *lHook = &l, *rHook = &r;  // СĿλ
+    Bnode_ptr t = _r;
+    while (!(v == t->v)) {
+        int i = v < t->v ? 0 : 1;
+        Bnode_ptr c = t->child[i];
+        if (c == NULL)
+            break;
+        if (!(v == c->v) && (v < c->v ? 0 : 1) == i) {  // һΣת
+            t->child[i] = c->child[1 - i];
+            c->child[1 - i] = t;
+            t = c;
+            if (t->child[i] == NULL)
+                break;
+        }
+        if (i == 0) {  // t 
+            *rHook = t;
+            rHook = &t->child[0];
+        }
+        else {
+            *lHook = t;
+            lHook = &t->child[1];
+        }
+        t = t->child[i];
+    }
+    *lHook = t->child[0];
+    *rHook = t->child[1];
+    t->child[0] = l;
+    t->child[1] = r;
+    _r = t;
+}
+
+}
+}
@@ -0,0 +1,127 @@
+#pragma once
+
+#include <cstddef>
+#include <utility>
+
+namespace sine {
+namespace tree {
+
+// n ڵ㲹֮ĴС
+constexpr size_t staticTreeSize(size_t n) {
+    return n == 0 ? 0 : 2 * staticTreeSize(n / 2) + 1;
+}
+
+// Ĳ
+constexpr size_t staticTreeDepth(size_t n) {
+    return n == 0 ? 0 : 1 + staticTreeDepth(n / 2);
+}
+
+/**
+ * ڹľ̬
+ * ظĳڱ Eytzinger ֣ŵ
+ * ڵ k ӽڵΪ 2k  2k+1ʱûйͷ䡣
+ * λԪزÿ find ̽ H 㣬
+ * չΪ̶ͣûз֧Ԥʧܡ BinarySearchTree::find ͬ
+ * T Ϊֵ͡÷
+ *     constexpr int keys[] = { 2, 3, 5, 7 };
+ *     constexpr StaticSearchTree<int, 4> table = makeStaticTree(keys);
+ *     static_assert(table.checkValid(), "keys must be sorted");
+ */
+template<class T, size_t N>
+class StaticSearchTree {
+
+public:
+
+    typedef const T * const_ptr;
+    typedef const T & const_ref;
+
+    // I Ϊ 0  staticTreeSize(N) - 1ͨ makeStaticTree á
+    template<size_t... I>
+    constexpr StaticSearchTree(const T (&sorted)[N], std::index_sequence<I...>)
+        : keys{ sorted[rank(I + 1) < N ? rank(I + 1) : N - 1]... } {}
+
+    constexpr const_ptr find(const_ref x) const {
+        return at(Descend<H>::go(keys, 1, 0, x), x);
+    }
+
+    constexpr bool checkValid() const {  // Ƿظ
+        return valid(0, N);
+    }
+
+    constexpr size_t size() const {
+        return N;
+    }
+
+private:
+
+    static const size_t M = staticTreeSize(N);  // ֮Ľڵ
+    static const size_t H = staticTreeDepth(N);
+
+    static constexpr size_t level(size_t k) {  // ڵ k ڵĲ㣬Ϊ 0 
+        return k == 1 ? 0 : 1 + level(k / 2);
+    }
+
+    //  l  j ڵ j øΪ H - l ټԼ
+    static constexpr size_t rank(size_t k) {  // ڵ k 
+        return rankAt(k, level(k));
+    }
+
+    static constexpr size_t rankAt(size_t k, size_t l) {
+        return ((2 * (k - ((size_t)1 << l)) + 1) << (H - 1 - l)) - 1;
+    }
+
+    static constexpr size_t zeros(size_t x) {  // x ĩβ 0 ĸx Ϊ 0
+        return x & 1 ? 0 : 1 + zeros(x / 2);
+    }
+
+    // Ϊ r Ľڵ㣬rank 棺r + 1 ĩβ z  0 ʱڵ H - 1 - z 㡣
+    static constexpr size_t node(size_t r) {
+        return nodeAt(r + 1, zeros(r + 1));
+    }
+
+    static constexpr size_t nodeAt(size_t x, size_t z) {
+        return ((size_t)1 << (H - 1 - z)) + (x >> (z + 1));
+    }
+
+    // ̽ D 㣬c ΪĿǰһС x Ľڵ㣬0 ʾûС
+    template<size_t D, int = 0>
+    struct Descend {
+        static constexpr size_t go(const T *a, size_t k, size_t c, const_ref x) {
+            return step(a, k, c, x, a[k - 1] < x);
+        }
+        static constexpr size_t step(const T *a, size_t k, size_t c, const_ref x, bool less) {
+            return Descend<D - 1>::go(a, 2 * k + less, less ? c : k, x);
+        }
+    };
+
+    template<int dummy>
+    struct Descend<0, dummy> {
+        static constexpr size_t go(const T *, size_t, size_t c, const_ref) {
+            return c;
+        }
+    };
+
+    constexpr const_ptr at(size_t k, const_ref x) const {
+        return k != 0 && keys[k - 1] == x ? &keys[k - 1] : NULL;
+    }
+
+    //  [lo, hi) ڵԪϸλ N ֮󣬲ؼ顣
+    // ֵݹ飬constexpr ĵݹֻ O(log N)
+    constexpr bool valid(size_t lo, size_t hi) const {
+        return hi - lo < 2 ? true
+            : hi - lo == 2 ? keys[node(lo) - 1] < keys[node(lo + 1) - 1]
+            : valid(lo, (lo + hi) / 2 + 1) && valid((lo + hi) / 2, hi);
+    }
+
+    T keys[M];  // keys[k - 1] Ϊڵ k
+
+};
+
+template<class T, size_t N>
+constexpr StaticSearchTree<T, N> makeStaticTree(const T (&sorted)[N]) {
+    return StaticSearchTree<T, N>(sorted,
+        std::make_index_sequence<staticTreeSize(N)>());
+}
+
+}
+}
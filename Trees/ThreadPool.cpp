@@ -0,0 +1,118 @@
+#include "stdafx.h"
+#include "ThreadPool.h"
+
+namespace sine {
+namespace tree {
+
+namespace {
+
+// ǰ̳߳߳غͶбš
+thread_local ThreadPool *currentPool = NULL;
+thread_local size_t currentQueue = 0;
+
+}
+
+ThreadPool::ThreadPool(size_t n)
+    : queued(0), stop(false) {
+    if (n == 0)
+        n = std::thread::hardware_concurrency();
+    if (n == 0)
+        n = 1;
+    for (size_t i = 0; i <= n; i++)
+        queues.push_back(new Queue());
+    for (size_t i = 0; i < n; i++)
+        threads.push_back(std::thread(&ThreadPool::work, this, i));
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> g(idleLock);
+        stop = true;
+    }
+    idle.notify_all();
+    for (size_t i = 0; i < threads.size(); i++)
+        threads[i].join();
+    for (size_t i = 0; i < queues.size(); i++) {
+        for (size_t j = 0; j < queues[i]->tasks.size(); j++)
+            delete queues[i]->tasks[j];
+        delete queues[i];
+    }
+}
+
+size_t ThreadPool::size() const {
+    return threads.size();
+}
+
+void ThreadPool::spawn(Task *t, TaskGroup &g) {
+    t->group = &g;
+    g.pending++;
+    queued++;  // ӣȡʱŲ 0 
+    Queue *q = queues[self()];
+    {
+        std::lock_guard<std::mutex> l(q->lock);
+        q->tasks.push_back(t);
+    }
+    std::lock_guard<std::mutex> l(idleLock);
+    idle.notify_one();
+}
+
+void ThreadPool::wait(TaskGroup &g) {
+    size_t s = self();
+    while (g.pending > 0)
+        if (!runOne(s))
+            std::this_thread::yield();
+}
+
+ThreadPool &ThreadPool::global() {
+    static ThreadPool pool;
+    return pool;
+}
+
+/**
+ * ȴԼĶβȡδеͷȡ
+ */
+bool ThreadPool::runOne(size_t s) {
+    Task *t = NULL;
+    for (size_t i = 0; i < queues.size() && t == NULL; i++) {
+        Queue *q = queues[(s + i) % queues.size()];
+        std::lock_guard<std::mutex> l(q->lock);
+        if (q->tasks.empty())
+            continue;
+        if (i == 0) {
+            t = q->tasks.back();
+            q->tasks.pop_back();
+        }
+        else {
+            t = q->tasks.front();
+            q->tasks.pop_front();
+        }
+    }
+    if (t == NULL)
+        return false;
+    queued--;
+    TaskGroup *g = t->group;
+    t->run();
+    delete t;
+    g->pending--;
+    return true;
+}
+
+void ThreadPool::work(size_t s) {
+    currentPool = this;
+    currentQueue = s;
+    for (;;) {
+        if (runOne(s))
+            continue;
+        std::unique_lock<std::mutex> l(idleLock);
+        idle.wait(l, [this] { return stop || queued > 0; });
+        if (stop)
+            return;
+    }
+}
+
+size_t ThreadPool::self() const {
+    return currentPool == this ? currentQueue : queues.size() - 1;
+}
+
+}
+}
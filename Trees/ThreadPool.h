@@ -0,0 +1,78 @@
+#pragma once
+
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include "CacheAligned.h"
+
+namespace sine {
+namespace tree {
+
+/**
+ * ȡ̳߳
+ * ÿ߳Լ˫˶УӶβȡԼ񣬿ʱӱĶͷȡ
+ * ȱȡǽġͨҲǽϴ
+ *  TaskGroup 飬wait ڵȴڼԼҲִпٲ񲢵ȴ
+ */
+class ThreadPool {
+
+public:
+
+    class TaskGroup;
+
+    class Task {
+    public:
+        virtual ~Task() {}
+        virtual void run() = 0;
+    private:
+        friend class ThreadPool;
+        TaskGroup *group;
+    };
+
+    class TaskGroup {
+    public:
+        TaskGroup() : pending(0) {}
+    private:
+        friend class ThreadPool;
+        std::atomic<size_t> pending;
+    };
+
+    explicit ThreadPool(size_t threads = 0);  // 0 ʾӲ߳ͬ
+    ~ThreadPool();
+
+    size_t size() const;
+
+    void spawn(Task *, TaskGroup &);  // ִк̳߳ɾ
+    void wait(TaskGroup &);
+
+    static ThreadPool &global();
+
+private:
+
+    ThreadPool(const ThreadPool &);
+    ThreadPool &operator=(const ThreadPool &);
+
+    class Queue : public CacheAligned {
+    public:
+        std::mutex lock;
+        std::deque<Task *> tasks;
+    };
+
+    bool runOne(size_t self);  // self Ϊǰ̵߳ĶУⲿ߳Ϊ queues.size()
+    void work(size_t self);
+    size_t self() const;
+
+    std::vector<Queue *> queues;  // һⲿ߳ύ
+    std::vector<std::thread> threads;
+    std::atomic<size_t> queued;
+    std::atomic<bool> stop;
+    std::mutex idleLock;
+    std::condition_variable idle;
+
+};
+
+}
+}
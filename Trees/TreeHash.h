@@ -0,0 +1,45 @@
+#pragma once
+
+#include <functional>
+
+namespace sine {
+namespace tree {
+
+/**
+ * ԪصɢкĬʹ std::hashԶҪػ
+ *  T  == һ¡
+ */
+template<class T>
+struct TreeHash {
+    size_t operator()(const T &v) const {
+        return std::hash<T>()(v);
+    }
+};
+
+/**
+ * ԪȫݵɢУڱȽϸMerkleTree
+ * Ĭ TreeHash ͬΪ == Ƚϵľȫݣ
+ * == ֻȽϼļ¼ҪػֶҲȥ
+ */
+template<class T>
+struct ContentHash {
+    size_t operator()(const T &v) const {
+        return TreeHash<T>()(v);
+    }
+};
+
+/**
+ * ɢֵɢȫ 64 λsplitmix64 Ļϲ裩
+ * ӳ֮ɢҲֱȡλ
+ */
+inline unsigned long long mixHash(unsigned long long h) {
+    h ^= h >> 30;
+    h *= 0xBF58476D1CE4E5B9ULL;
+    h ^= h >> 27;
+    h *= 0x94D049BB133111EBULL;
+    h ^= h >> 31;
+    return h;
+}
+
+}
+}
@@ -3,24 +3,124 @@
 
 #include "stdafx.h"
 #include <stack>
+#include <vector>
+#include <string>
+#include <algorithm>
 #include <iostream>
 #include <ctime>
+#include <chrono>
+#include <atomic>
 #include "NormalBST.h"
 #include "AVLTree.h"
 #include "RBTree.h"
+#include "WAVLTree.h"
+#include "SplayTree.h"
+#include "ScapegoatTree.h"
+#include "AdaptiveRadixTree.h"
+#include "BloomFilteredTree.h"
+#include "BeTree.h"
+#include "ShardedTree.h"
+#include "IntervalTree.h"
+#include "PrefixedString.h"
+#include "SmallTree.h"
+#include "StaticSearchTree.h"
+#include "MerkleTree.h"
+#include "HashIndexedTree.h"
+#include "CompressedIndex.h"
+#include "KdTree.h"
 #include "Timer.h"
 
 using namespace sine::tree;
 using namespace std;
 
 int insertNum = 100000, removeNum = 100000, findNum = 100000;
+int zipfKeys = 1 << 16, zipfNum = 1000000;
+int ingestNum = 1000000, ingestCache = 128;
+
+// The first 256 primes, as a fixed lookup table built at compile time.
+constexpr int primes[] = {
+    2, 3, 5, 7, 11, 13, 17, 19, 23, 29, 31, 37, 41, 43, 47, 53,
+    59, 61, 67, 71, 73, 79, 83, 89, 97, 101, 103, 107, 109, 113, 127, 131,
+    137, 139, 149, 151, 157, 163, 167, 173, 179, 181, 191, 193, 197, 199, 211, 223,
+    227, 229, 233, 239, 241, 251, 257, 263, 269, 271, 277, 281, 283, 293, 307, 311,
+    313, 317, 331, 337, 347, 349, 353, 359, 367, 373, 379, 383, 389, 397, 401, 409,
+    419, 421, 431, 433, 439, 443, 449, 457, 461, 463, 467, 479, 487, 491, 499, 503,
+    509, 521, 523, 541, 547, 557, 563, 569, 571, 577, 587, 593, 599, 601, 607, 613,
+    617, 619, 631, 641, 643, 647, 653, 659, 661, 673, 677, 683, 691, 701, 709, 719,
+    727, 733, 739, 743, 751, 757, 761, 769, 773, 787, 797, 809, 811, 821, 823, 827,
+    829, 839, 853, 857, 859, 863, 877, 881, 883, 887, 907, 911, 919, 929, 937, 941,
+    947, 953, 967, 971, 977, 983, 991, 997, 1009, 1013, 1019, 1021, 1031, 1033, 1039, 1049,
+    1051, 1061, 1063, 1069, 1087, 1091, 1093, 1097, 1103, 1109, 1117, 1123, 1129, 1151, 1153, 1163,
+    1171, 1181, 1187, 1193, 1201, 1213, 1217, 1223, 1229, 1231, 1237, 1249, 1259, 1277, 1279, 1283,
+    1289, 1291, 1297, 1301, 1303, 1307, 1319, 1321, 1327, 1361, 1367, 1373, 1381, 1399, 1409, 1423,
+    1427, 1429, 1433, 1439, 1447, 1451, 1453, 1459, 1471, 1481, 1483, 1487, 1489, 1493, 1499, 1511,
+    1523, 1531, 1543, 1549, 1553, 1559, 1567, 1571, 1579, 1583, 1597, 1601, 1607, 1609, 1613, 1619
+};
+constexpr StaticSearchTree<int, 256> primeTable = makeStaticTree(primes);
+static_assert(primeTable.checkValid(), "primes must be sorted");
 
 class Container;
 void handler(Container &);
 void const_handler(const Container &c);
-void test(BinarySearchTree<Container> *t);
+void test(SearchTree<Container> *t);
+void testZipf(SearchTree<Container> *t);
+void testSorted(SearchTree<Container> *t);
+void testHinted(FingerBT<Container> *t);
+void testFilteredHinted();
+void testRelaxed(RBTree<Container> *t);
+void testIngest(BeTree<Container> *t);
+void testWindow(BeTree<Container> *t);
+void testBatch(ShardedTree<Container> *t);
+void testRangeBatch(int shards);
+void testInterval();
+void testStringKeys();
+void testStaticTable();
+void testDiff();
+void testParallel(RBTree<Container> *t);
+void testKd();
 int random(int bit = 18);
 
+// Sum of Container::d, for the augmented trees.
+struct SumD {
+    typedef long long value_type;
+    static value_type identity();
+    static value_type of(const Container &);
+    static value_type combine(const value_type &, const value_type &);
+};
+
+template<class Tree>
+void testAggregate(Tree *t);
+template<class Tree>
+void testManySmall();
+template<class Tree>
+void testCompact(Tree *t);
+template<class Tree>
+void testRotations(Tree *t);
+template<class K>
+void testCompressed(int bit);
+
+namespace sine {
+namespace tree {
+template<>
+struct RadixKey<Container> {
+    static void bytes(const Container &, string &);
+};
+template<>
+struct TreeHash<Container> {
+    size_t operator()(const Container &) const;
+};
+template<>
+struct ContentHash<Container> {
+    size_t operator()(const Container &) const;
+};
+template<>
+struct KdKey<Container> {
+    typedef int value_type;
+    static value_type at(const Container &, int dim);
+};
+}
+}
+
 int main()
 {
     long long curtime = time(NULL);
@@ -33,6 +133,13 @@ int main()
         RBTree<Container> b(a);
     }
     
+    {
+        srand(curtime & 0xFFFFFFFF);
+        cout << "RBTree (relaxed)" << endl;
+        RBTree<Container> a;
+        testRelaxed(&a);
+    }
+
     {
         srand(curtime & 0xFFFFFFFF);
         cout << "AVLTree" << endl;
@@ -41,6 +148,15 @@ int main()
         AVLTree<Container> b(a);
     }
 
+    {
+        srand(curtime & 0xFFFFFFFF);
+        cout << "WAVLTree" << endl;
+        WAVLTree<Container> a;
+        test(&a);
+        cout << "checkBalance: " << a.checkBalance() << endl;
+        WAVLTree<Container> b(a);
+    }
+
     {
         srand(curtime & 0xFFFFFFFF);
         cout << "NormalBST" << endl;
@@ -49,6 +165,282 @@ int main()
         NormalBST<Container> b(a);
     }
 
+    {
+        srand(curtime & 0xFFFFFFFF);
+        cout << "SplayTree" << endl;
+        SplayTree<Container> a;
+        test(&a);
+        SplayTree<Container> b(a);
+    }
+
+    {
+        srand(curtime & 0xFFFFFFFF);
+        cout << "ScapegoatTree" << endl;
+        ScapegoatTree<Container> a;
+        test(&a);
+        cout << "checkBalance: " << a.checkBalance() << endl;
+        ScapegoatTree<Container> b(a);
+    }
+
+    {
+        srand(curtime & 0xFFFFFFFF);
+        cout << "AdaptiveRadixTree" << endl;
+        AdaptiveRadixTree<Container> a;
+        test(&a);
+        AdaptiveRadixTree<Container> b(a);
+    }
+
+    {
+        srand(curtime & 0xFFFFFFFF);
+        cout << "BloomFilteredTree<RBTree>" << endl;
+        BloomFilteredTree<Container> a(insertNum);
+        test(&a);
+        cout << "filter: " << a.filterMemoryUsage() << " bytes, estimated fpr "
+            << a.falsePositiveRate() << ", observed fpr "
+            << a.observedFalsePositiveRate() << endl;
+        BloomFilteredTree<Container> b(a);
+        testFilteredHinted();
+    }
+
+    {
+        srand(curtime & 0xFFFFFFFF);
+        cout << "HashIndexedTree<RBTree>" << endl;
+        HashIndexedTree<Container> a;
+        test(&a);
+        cout << "index: " << a.indexMemoryUsage() << " bytes, nodes: "
+            << a.memoryStats().bytes << " bytes" << endl;
+    }
+
+    {
+        srand(curtime & 0xFFFFFFFF);
+        cout << "ShardedTree<RBTree> (8 hash shards)" << endl;
+        ShardedTree<Container> a(8);
+        test(&a);
+        ShardedTree<Container> b(8);
+        testBatch(&b);
+    }
+
+    {
+        srand(curtime & 0xFFFFFFFF);
+        cout << "ShardedTree<RBTree> (8 range shards)" << endl;
+        testRangeBatch(8);
+    }
+
+    {
+        srand(curtime & 0xFFFFFFFF);
+        cout << "BeTree" << endl;
+        BeTree<Container> a("betree.dat", 64);
+        test(&a);
+    }
+
+    {
+        srand(curtime & 0xFFFFFFFF);
+        cout << "BeTree (ingest, cache " << ingestCache << " pages)" << endl;
+        {
+            BeTree<Container> a("betree.dat", ingestCache);
+            testIngest(&a);
+        }
+        remove("betree.dat");
+    }
+
+    {
+        cout << "BeTree (sliding window, cache " << ingestCache << " pages)" << endl;
+        {
+            BeTree<Container> a("betree.dat", ingestCache);
+            testWindow(&a);
+        }
+        remove("betree.dat");
+    }
+
+    {
+        srand(curtime & 0xFFFFFFFF);
+        cout << "RBTree<SumD>" << endl;
+        RBTree<Container, Augment<SumD> > a;
+        test(&a);
+        testAggregate(&a);
+    }
+
+    {
+        srand(curtime & 0xFFFFFFFF);
+        cout << "AVLTree<SumD>" << endl;
+        AVLTree<Container, Augment<SumD> > a;
+        test(&a);
+        testAggregate(&a);
+    }
+
+    {
+        srand(curtime & 0xFFFFFFFF);
+        cout << "IntervalTree" << endl;
+        testInterval();
+    }
+
+    {
+        srand(curtime & 0xFFFFFFFF);
+        cout << "RBTree<string> / RBTree<PrefixedString>" << endl;
+        testStringKeys();
+    }
+
+    {
+        srand(curtime & 0xFFFFFFFF);
+        cout << "RBTree (parallel scan, " << ThreadPool::global().size() << " threads)" << endl;
+        RBTree<Container> a;
+        testParallel(&a);
+    }
+
+    {
+        srand(curtime & 0xFFFFFFFF);
+        cout << "RBTree (churn, compact)" << endl;
+        RBTree<Container> a;
+        testCompact(&a);
+    }
+
+    {
+        srand(curtime & 0xFFFFFFFF);
+        cout << "AVLTree (churn, compact)" << endl;
+        AVLTree<Container> a;
+        testCompact(&a);
+    }
+
+    {
+        srand(curtime & 0xFFFFFFFF);
+        cout << "RBTree (rotations)" << endl;
+        RBTree<Container, NoAugment, CountRotations> a;
+        testRotations(&a);
+    }
+
+    {
+        srand(curtime & 0xFFFFFFFF);
+        cout << "AVLTree (rotations)" << endl;
+        AVLTree<Container, NoAugment, CountRotations> a;
+        testRotations(&a);
+    }
+
+    {
+        srand(curtime & 0xFFFFFFFF);
+        cout << "WAVLTree (rotations)" << endl;
+        WAVLTree<Container, NoAugment, CountRotations> a;
+        testRotations(&a);
+    }
+
+    {
+        srand(curtime & 0xFFFFFFFF);
+        cout << "MerkleTree (replica diff)" << endl;
+        testDiff();
+    }
+
+    {
+        srand(curtime & 0xFFFFFFFF);
+        cout << "StaticSearchTree / RBTree (prime table)" << endl;
+        testStaticTable();
+    }
+
+    {
+        srand(curtime & 0xFFFFFFFF);
+        cout << "CompressedIndex<int> (18-bit keys)" << endl;
+        testCompressed<int>(18);
+    }
+
+    {
+        srand(curtime & 0xFFFFFFFF);
+        cout << "CompressedIndex<long long> (30-bit keys)" << endl;
+        testCompressed<long long>(30);
+    }
+
+    {
+        srand(curtime & 0xFFFFFFFF);
+        cout << "KdTree<2> / filter scan (i, d)" << endl;
+        testKd();
+    }
+
+    {
+        srand(curtime & 0xFFFFFFFF);
+        cout << "RBTree (many small trees)" << endl;
+        testManySmall<RBTree<Container> >();
+    }
+
+    {
+        srand(curtime & 0xFFFFFFFF);
+        cout << "SmallTree (many small trees)" << endl;
+        testManySmall<SmallTree<Container> >();
+    }
+
+    {
+        cout << "RBTree (sorted)" << endl;
+        RBTree<Container> a;
+        testSorted(&a);
+    }
+
+    {
+        cout << "AVLTree (sorted)" << endl;
+        AVLTree<Container> a;
+        testSorted(&a);
+    }
+
+    {
+        cout << "RBTree (sorted, hinted)" << endl;
+        RBTree<Container> a;
+        testHinted(&a);
+    }
+
+    {
+        cout << "AVLTree (sorted, hinted)" << endl;
+        AVLTree<Container> a;
+        testHinted(&a);
+    }
+
+    {
+        cout << "WAVLTree (sorted, hinted)" << endl;
+        WAVLTree<Container> a;
+        testHinted(&a);
+    }
+
+    {
+        cout << "ScapegoatTree (sorted)" << endl;
+        ScapegoatTree<Container> a;
+        testSorted(&a);
+    }
+
+    {
+        cout << "AdaptiveRadixTree (sorted)" << endl;
+        AdaptiveRadixTree<Container> a;
+        testSorted(&a);
+    }
+
+    {
+        srand(curtime & 0xFFFFFFFF);
+        cout << "RBTree (zipf)" << endl;
+        RBTree<Container> a;
+        testZipf(&a);
+    }
+
+    {
+        srand(curtime & 0xFFFFFFFF);
+        cout << "AVLTree (zipf)" << endl;
+        AVLTree<Container> a;
+        testZipf(&a);
+    }
+
+    {
+        srand(curtime & 0xFFFFFFFF);
+        cout << "SplayTree (zipf)" << endl;
+        SplayTree<Container> a;
+        testZipf(&a);
+    }
+
+    {
+        srand(curtime & 0xFFFFFFFF);
+        cout << "SplayTree (zipf, splay every 4th find)" << endl;
+        SplayTree<Container> a(4);
+        testZipf(&a);
+    }
+
+    {
+        srand(curtime & 0xFFFFFFFF);
+        cout << "AdaptiveRadixTree (zipf)" << endl;
+        AdaptiveRadixTree<Container> a;
+        testZipf(&a);
+    }
+
     system("pause");
     return 0;
 }
@@ -65,6 +457,34 @@ public:
     }
 };
 
+void sine::tree::RadixKey<Container>::bytes(const Container &c, string &out) {
+    IntegerRadixKey<int>::bytes(c.i, out);
+}
+
+size_t sine::tree::TreeHash<Container>::operator()(const Container &c) const {
+    return std::hash<int>()(c.i);
+}
+
+size_t sine::tree::ContentHash<Container>::operator()(const Container &c) const {
+    return (size_t)mixHash(((unsigned long long)(unsigned)c.i << 32) | (unsigned)c.d);
+}
+
+int sine::tree::KdKey<Container>::at(const Container &c, int dim) {
+    return dim == 0 ? c.i : c.d;
+}
+
+SumD::value_type SumD::identity() {
+    return 0;
+}
+
+SumD::value_type SumD::of(const Container &c) {
+    return c.d;
+}
+
+SumD::value_type SumD::combine(const value_type &a, const value_type &b) {
+    return a + b;
+}
+
 void handler(Container &c) {
     cout << c.i << " ";
 }
@@ -74,7 +494,7 @@ void const_handler(const Container &c) {
     cout << i++ << " " << c.i << endl;
 }
 
-void test(BinarySearchTree<Container> *t) {
+void test(SearchTree<Container> *t) {
     Timer timer;
     timer.update();
     for (int i = 0; i < insertNum; i++) {
@@ -104,6 +524,609 @@ void test(BinarySearchTree<Container> *t) {
     cout << "find: " << timer.update() << endl;
 }
 
+void testSorted(SearchTree<Container> *t) {
+    Timer timer;
+    timer.update();
+    for (int i = 0; i < insertNum; i++) {
+        t->insert(Container(i, 1));
+    }
+    cout << "sorted insert: " << timer.update() << endl;
+    cout << "checkValid: " << t->checkValid() << endl;
+
+    timer.update();
+    for (int i = 0; i < findNum; i++) {
+        Container a(random() % insertNum, 0);
+        t->find(a);
+    }
+    cout << "find: " << timer.update() << endl;
+}
+
+// Writes in relaxed mode, then the deferred repair, then the usual finds.
+void testRelaxed(RBTree<Container> *t) {
+    Timer timer;
+    t->setRelaxed(true);
+    timer.update();
+    for (int i = 0; i < insertNum; i++) {
+        t->insert(Container(random(), 1));
+    }
+    cout << "relaxed insert: " << timer.update() << endl;
+    for (int i = 0; i < removeNum; i++) {
+        t->remove(Container(random(), 1));
+    }
+    cout << "relaxed remove: " << timer.update() << " (" << t->pending() << " pending)" << endl;
+
+    // A relaxed insert over a dead node must take the new payload.
+    Container revived(1 << 20, 2);
+    t->insert(Container(revived.i, 1));
+    t->remove(revived);
+    t->insert(revived);
+    Container *p = t->find(Container(revived.i, 0));
+    cout << "revived payload: " << (p != NULL && p->d == revived.d) << endl;
+
+    timer.update();
+    t->rebalance();
+    cout << "rebalance: " << timer.update() << endl;
+    cout << "checkBalance: " << t->checkBalance() << endl;
+
+    for (int i = 0; i < findNum; i++) {
+        Container a(random(), 0);
+        t->find(a);
+    }
+    cout << "find: " << timer.update() << endl;
+}
+
+// Range sums through the augmentation, against an in-order scan of the same ranges.
+template<class Tree>
+void testAggregate(Tree *t) {
+    int queries = findNum / 100;
+    vector<int> lo(queries), hi(queries);
+    for (int i = 0; i < queries; i++) {
+        lo[i] = random();
+        hi[i] = lo[i] + random(14);
+    }
+
+    Timer timer;
+    long long sum = 0;
+    timer.update();
+    for (int i = 0; i < queries; i++)
+        sum += t->aggregate(Container(lo[i], 0), Container(hi[i], 0));
+    cout << "aggregate: " << timer.update() << " (" << sum << ")" << endl;
+
+    sum = 0;
+    timer.update();
+    for (int i = 0; i < queries; i++)
+        for (typename Tree::const_iterator j = t->begin(); j != t->end(); ++j)
+            if (lo[i] <= j->i && j->i <= hi[i])
+                sum += j->d;
+    cout << "scan: " << timer.update() << " (" << sum << ")" << endl;
+}
+
+// Counts the intervals reported by a query.
+struct CountInterval {
+    int *count;
+    void operator()(const Interval<int> &) const { (*count)++; }
+};
+
+// Overlap and stabbing queries, against a scan over all intervals.
+void testInterval() {
+    IntervalTree<int> t;
+    for (int i = 0; i < insertNum; i++) {
+        int lo = random();
+        t.insert(Interval<int>(lo, lo + random(10)));
+    }
+    int queries = findNum / 10;
+    vector<int> lo(queries), hi(queries);
+    for (int i = 0; i < queries; i++) {
+        lo[i] = random();
+        hi[i] = lo[i] + random(8);
+    }
+
+    Timer timer;
+    int count = 0;
+    CountInterval f = { &count };
+    timer.update();
+    for (int i = 0; i < queries; i++)
+        t.overlapping(lo[i], hi[i], f);
+    cout << "overlapping: " << timer.update() << " (" << count << ")" << endl;
+    count = 0;
+    for (int i = 0; i < queries; i++)
+        t.stabbing(lo[i], f);
+    cout << "stabbing: " << timer.update() << " (" << count << ")" << endl;
+
+    count = 0;
+    timer.update();
+    for (int i = 0; i < queries / 100; i++)
+        for (IntervalTree<int>::const_iterator j = t.begin(); j != t.end(); ++j)
+            if (j->lo <= hi[i] && lo[i] <= j->hi)
+                count++;
+    cout << "scan (1/100 of the queries): " << timer.update() << " (" << count << ")" << endl;
+}
+
+long long hashD(const Container &c) {
+    return (long long)(mixHash(c.d) >> 40);
+}
+
+long long addD(long long a, long long b) {
+    return a + b;
+}
+
+struct AddHashD {
+    atomic<long long> *total;
+    void operator()(const Container &c) const { *total += hashD(c); }
+};
+
+// Milliseconds of wall time; clock() adds up the CPU time of all threads on Linux.
+long long wallMs() {
+    return chrono::duration_cast<chrono::milliseconds>(
+        chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// A scan reducing every element, sequential and on the shared work-stealing pool.
+void testParallel(RBTree<Container> *t) {
+    for (int i = 0; i < insertNum * 10; i++)
+        t->insert(Container(random(30), random()));
+    int rounds = 10;
+
+    long long sum = 0, start = wallMs();
+    for (int r = 0; r < rounds; r++)
+        for (RBTree<Container>::const_iterator i = t->begin(); i != t->end(); ++i)
+            sum += hashD(*i);
+    cout << "sequential reduce: " << wallMs() - start << "ms (" << sum << ")" << endl;
+
+    sum = 0;
+    start = wallMs();
+    for (int r = 0; r < rounds; r++)
+        sum += t->parallelReduce(0LL, hashD, addD);
+    cout << "parallelReduce: " << wallMs() - start << "ms (" << sum << ")" << endl;
+
+    atomic<long long> total(0);
+    AddHashD f = { &total };
+    start = wallMs();
+    for (int r = 0; r < rounds; r++)
+        t->parallelForEach(f);
+    cout << "parallelForEach: " << wallMs() - start << "ms (" << total << ")" << endl;
+}
+
+void printStats(const MemoryStats &m) {
+    cout << "nodes: " << m.nodes << ", bytes: " << m.bytes
+        << ", fragmentation: " << m.fragmentation << ", height: " << m.depths.size() << endl;
+}
+
+// Finds on a tree after heavy insert/remove churn, before and after compact().
+template<class Tree>
+void testCompact(Tree *t) {
+    for (int i = 0; i < insertNum * 10; i++) {
+        t->insert(Container(random(22), 1));
+        t->remove(Container(random(22), 1));
+    }
+    printStats(t->memoryStats());
+
+    Timer timer;
+    int count = 0;
+    timer.update();
+    for (int i = 0; i < findNum * 10; i++)
+        if (t->find(Container(random(22), 0)))
+            count++;
+    cout << "find: " << timer.update() << " (" << count << " hits)" << endl;
+    t->compact();
+    cout << "compact: " << timer.update() << endl;
+    printStats(t->memoryStats());
+    count = 0;
+    timer.update();
+    for (int i = 0; i < findNum * 10; i++)
+        if (t->find(Container(random(22), 0)))
+            count++;
+    cout << "find: " << timer.update() << " (" << count << " hits)" << endl;
+}
+
+// Rotations per successful insert and remove, and the height afterwards.
+template<class Tree>
+void testRotations(Tree *t) {
+    int count = 0;
+    Tree::resetRotationCount();
+    for (int i = 0; i < insertNum; i++)
+        if (t->insert(Container(random(), 1)))
+            count++;
+    cout << "insert: " << (double)Tree::rotationCount() / count << " rotations each, height "
+        << t->memoryStats().depths.size() << endl;
+
+    count = 0;
+    Tree::resetRotationCount();
+    for (int i = 0; i < removeNum * 4; i++)
+        if (t->remove(Container(random(), 1)))
+            count++;
+    cout << "remove: " << (double)Tree::rotationCount() / count << " rotations each, height "
+        << t->memoryStats().depths.size() << endl;
+}
+
+template<class K>
+struct SumKeys {
+    long long *sum;
+    void operator()(K k) const { *sum += k; }
+};
+
+// The same keys as an RBTree, a sorted array and a CompressedIndex:
+// memory, finds, and short range scans.
+template<class K>
+void testCompressed(int bit) {
+    RBTree<K> t;
+    for (int i = 0; i < insertNum * 10; i++)
+        t.insert(random(bit));
+    CompressedIndex<K> c(t);
+    vector<K> v;
+    for (typename RBTree<K>::const_iterator i = t.begin(); i != t.end(); ++i)
+        v.push_back(*i);
+    cout << "keys: " << c.size() << ", RBTree: " << t.memoryStats().bytes << " bytes, array: "
+        << v.size() * sizeof(K) << " bytes, compressed: " << c.memoryUsage() << " bytes" << endl;
+
+    vector<K> q(findNum * 10);
+    for (size_t i = 0; i < q.size(); i++)
+        q[i] = random(bit);
+    Timer timer;
+    int count = 0;
+    timer.update();
+    for (size_t i = 0; i < q.size(); i++)
+        if (t.find(q[i]))
+            count++;
+    cout << "RBTree find: " << timer.update() << " (" << count << " hits)" << endl;
+    count = 0;
+    for (size_t i = 0; i < q.size(); i++)
+        if (binary_search(v.begin(), v.end(), q[i]))
+            count++;
+    cout << "array find: " << timer.update() << " (" << count << " hits)" << endl;
+    count = 0;
+    for (size_t i = 0; i < q.size(); i++)
+        if (c.find(q[i]))
+            count++;
+    cout << "compressed find: " << timer.update() << " (" << count << " hits)" << endl;
+
+    long long sum = 0;
+    K width = (K)1 << (bit - 8);
+    for (size_t i = 0; i < q.size() / 10; i++)
+        for (typename vector<K>::iterator j = lower_bound(v.begin(), v.end(), q[i]);
+            j != v.end() && *j <= q[i] + width; ++j)
+            sum += *j;
+    cout << "array range: " << timer.update() << " (" << sum << ")" << endl;
+    sum = 0;
+    SumKeys<K> f = { &sum };
+    for (size_t i = 0; i < q.size() / 10; i++)
+        c.range(q[i], q[i] + width, f);
+    cout << "compressed range: " << timer.update() << " (" << sum << ")" << endl;
+}
+
+struct SumBox {
+    long long *sum;
+    void operator()(const Container &c) const { *sum += c.d; }
+};
+
+double distance2(const Container &a, const Container &b) {
+    double x = (double)a.i - b.i, y = (double)a.d - b.d;
+    return x * x + y * y;
+}
+
+// Box and 10-nearest queries over both fields of random records:
+// a 2-d tree against scanning all records and filtering.
+void testKd() {
+    vector<Container> v;
+    for (int i = 0; i < insertNum; i++)
+        v.push_back(Container(random(), random()));
+    Timer timer;
+    timer.update();
+    KdTree<Container, 2> a(v);
+    cout << "build: " << timer.update() << endl;
+    KdTree<Container, 2> b;
+    for (size_t i = 0; i < v.size(); i++)
+        b.insert(v[i]);
+    cout << "insert: " << timer.update() << endl;
+    cout << "checkValid: " << (a.checkValid() && b.checkValid())
+        << ", checkBalance: " << (a.checkBalance() && b.checkBalance()) << endl;
+
+    vector<Container> rows;
+    for (BinaryTree<Container>::const_iterator i = a.begin(); i != a.end(); ++i)
+        rows.push_back(*i);
+    int queries = findNum / 100, side = 1 << 12;
+    vector<Container> q;
+    for (int i = 0; i < queries; i++)
+        q.push_back(Container(random(), random()));
+
+    long long sum = 0;
+    timer.update();
+    for (int i = 0; i < queries; i++)
+        for (size_t j = 0; j < rows.size(); j++)
+            if (rows[j].i >= q[i].i && rows[j].i <= q[i].i + side
+                && rows[j].d >= q[i].d && rows[j].d <= q[i].d + side)
+                sum += rows[j].d;
+    cout << "scan box: " << timer.update() << " (" << sum << ")" << endl;
+    sum = 0;
+    SumBox f = { &sum };
+    for (int i = 0; i < queries; i++)
+        a.range(q[i], Container(q[i].i + side, q[i].d + side), f);
+    cout << "kd box: " << timer.update() << " (" << sum << ")" << endl;
+
+    const size_t k = 10;
+    double total = 0;
+    vector<double> dist(rows.size());
+    for (int i = 0; i < queries; i++) {
+        for (size_t j = 0; j < rows.size(); j++)
+            dist[j] = distance2(q[i], rows[j]);
+        nth_element(dist.begin(), dist.begin() + (k - 1), dist.end());
+        total += dist[k - 1];
+    }
+    cout << "scan nearest: " << timer.update() << " (" << total << ")" << endl;
+    total = 0;
+    vector<const Container *> out;
+    for (int i = 0; i < queries; i++) {
+        a.nearest(q[i], k, out);
+        total += distance2(q[i], *out.back());
+    }
+    cout << "kd nearest: " << timer.update() << " (" << total << ")" << endl;
+
+    // Removing the elements nearest the median x hits the root and its neighbours first.
+    sort(rows.begin(), rows.end());
+    size_t mid = rows.size() / 2, removed = 0;
+    timer.update();
+    for (size_t j = 0; j < rows.size() / 10; j++)
+        if (a.remove(rows[j % 2 ? mid + (j + 1) / 2 : mid - j / 2]))
+            removed++;
+    cout << "kd remove near median: " << timer.update() << " (" << removed << " removed)" << endl;
+    cout << "checkValid: " << a.checkValid() << ", checkBalance: " << a.checkBalance() << endl;
+}
+
+// Two replicas built in different orders with a few missing records and changed
+// payloads, compared by subtree hashes and by merging both in-order scans.
+void testDiff() {
+    vector<int> keys;
+    for (int i = 0; i < insertNum; i++)
+        keys.push_back(random());
+    MerkleTree<Container> a, b;
+    for (int i = 0; i < insertNum; i++) {
+        a.insert(Container(keys[i], 1));
+        b.insert(Container(keys[insertNum - 1 - i], 1));
+    }
+    for (int i = 0; i < 10; i++) {
+        a.remove(Container(keys[random(30) % insertNum], 0));
+        b.insert(Container(random(), 1));
+    }
+    for (int i = 0; i < 5; i++) {  // same key, different payload
+        Container c(keys[random(30) % insertNum], 2);
+        if (a.find(c) != NULL && b.remove(c))
+            b.insert(c);
+    }
+
+    Timer timer;
+    vector<Container> onlyA, onlyB;
+    timer.update();
+    size_t count = a.diff(b, onlyA, onlyB);
+    cout << "diff: " << timer.update() << " (" << count << " differences)" << endl;
+
+    count = 0;
+    timer.update();
+    MerkleTree<Container>::const_iterator i = a.begin(), j = b.begin();
+    while (i != a.end() || j != b.end()) {
+        if (j == b.end() || (i != a.end() && *i < *j)) {
+            ++i;
+            count++;
+        }
+        else if (i == a.end() || *j < *i) {
+            ++j;
+            count++;
+        }
+        else {
+            if (i->d != j->d)
+                count += 2;
+            ++i;
+            ++j;
+        }
+    }
+    cout << "merge scan: " << timer.update() << " (" << count << " differences)" << endl;
+}
+
+// Membership tests against the compile-time prime table and the same keys loaded into an RBTree.
+void testStaticTable() {
+    vector<int> q(findNum * 10);
+    for (size_t i = 0; i < q.size(); i++)
+        q[i] = random(11);
+
+    Timer timer;
+    int count = 0;
+    timer.update();
+    for (size_t i = 0; i < q.size(); i++)
+        if (primeTable.find(q[i]))
+            count++;
+    cout << "static find: " << timer.update() << " (" << count << " hits)" << endl;
+
+    RBTree<int> t;
+    for (size_t i = 0; i < primeTable.size(); i++)
+        t.insert(primes[i]);
+    cout << "RBTree load: " << timer.update() << endl;
+    count = 0;
+    for (size_t i = 0; i < q.size(); i++)
+        if (t.find(q[i]))
+            count++;
+    cout << "RBTree find: " << timer.update() << " (" << count << " hits)" << endl;
+}
+
+// insertNum elements spread over trees of about 6 elements each.
+template<class Tree>
+void testManySmall() {
+    int trees = insertNum / 6;
+    vector<int> keys(insertNum);
+    for (int i = 0; i < insertNum; i++)
+        keys[i] = random();
+    Timer timer;
+    timer.update();
+    vector<Tree> t(trees);
+    for (int i = 0; i < insertNum; i++)
+        t[i % trees].insert(Container(keys[i], 1));
+    cout << "insert: " << timer.update() << endl;
+    int count = 0;
+    for (int i = 0; i < findNum; i++) {
+        int j = random(30) % insertNum;
+        if (t[j % trees].find(Container(keys[j], 0)))
+            count++;
+    }
+    cout << "find: " << timer.update() << " (" << count << " hits)" << endl;
+    for (int i = 0; i < removeNum; i++)
+        t[i % trees].remove(Container(keys[i], 0));
+    cout << "remove: " << timer.update() << endl;
+}
+
+template<class K>
+void testKeys(SearchTree<K> *t, const vector<string> &keys) {
+    Timer timer;
+    timer.update();
+    for (size_t i = 0; i < keys.size(); i++)
+        t->insert(keys[i]);
+    cout << "insert: " << timer.update() << endl;
+    int count = 0;
+    for (int i = 0; i < findNum; i++)
+        if (t->find(keys[random(30) % keys.size()]))
+            count++;
+    cout << "find: " << timer.update() << " (" << count << " hits)" << endl;
+}
+
+// Path-like string keys, plain strings against strings with an inline prefix.
+void testStringKeys() {
+    vector<string> keys(insertNum);
+    for (int i = 0; i < insertNum; i++) {
+        for (int j = 0; j < 3; j++) {
+            keys[i] += '/';
+            for (int n = 3 + random(3); n > 0; n--)
+                keys[i] += (char)('a' + random(30) % 26);
+        }
+    }
+    {
+        RBTree<string> t;
+        testKeys(&t, keys);
+    }
+    {
+        RBTree<PrefixedString> t;
+        testKeys(&t, keys);
+    }
+}
+
+// Ascending insert, each one hinted with the previous insertion position.
+void testHinted(FingerBT<Container> *t) {
+    Timer timer;
+    timer.update();
+    for (int i = 0; i < insertNum; i++) {
+        t->insert(t->finger(), Container(i, 1));
+    }
+    cout << "hinted insert: " << timer.update() << endl;
+    cout << "checkValid: " << t->checkValid() << endl;
+    cout << "checkBalance: " << t->checkBalance() << endl;
+}
+
+// Hinted inserts through a FingerBT pointer must still reach the filter.
+void testFilteredHinted() {
+    BloomFilteredTree<Container> t(insertNum);
+    testHinted(&t);
+    int found = 0;
+    for (int i = 0; i < insertNum; i++)
+        found += t.find(Container(i, 0)) != NULL;
+    cout << "hinted elements found: " << found << " of " << insertNum << endl;
+}
+
+// Batched insert and remove applied to all shards in parallel, then an ordered scan.
+void testBatch(ShardedTree<Container> *t) {
+    vector<Container> ins, rem;
+    for (int i = 0; i < insertNum; i++)
+        ins.push_back(Container(random(), 1));
+    for (int i = 0; i < removeNum; i++)
+        rem.push_back(Container(random(), 1));
+
+    Timer timer;
+    timer.update();
+    size_t count = t->insertAll(ins);
+    cout << "batch insert: " << timer.update() << " (" << count << " inserted)" << endl;
+    count = t->removeAll(rem);
+    cout << "batch remove: " << timer.update() << " (" << count << " removed)" << endl;
+    cout << "checkValid: " << t->checkValid() << endl;
+
+    timer.update();
+    count = 0;
+    for (ShardedTree<Container>::const_iterator i = t->begin(); i != t->end(); ++i)
+        count++;
+    cout << "ordered scan: " << timer.update() << " (" << count << " elements)" << endl;
+}
+
+// Range shards split the random(18) key space evenly.
+void testRangeBatch(int shards) {
+    vector<Container> splitters;
+    for (int i = 1; i < shards; i++)
+        splitters.push_back(Container((int)((1LL << 18) * i / shards), 0));
+    ShardedTree<Container> t(splitters);
+    testBatch(&t);
+}
+
+// Zipf(s = 1) distributed find over zipfKeys keys, hot keys scattered randomly.
+void testZipf(SearchTree<Container> *t) {
+    vector<int> keys(zipfKeys);
+    for (int i = 0; i < zipfKeys; i++)
+        keys[i] = i;
+    for (int i = zipfKeys - 1; i > 0; i--)
+        swap(keys[i], keys[random(30) % (i + 1)]);
+    vector<double> cdf(zipfKeys);
+    double sum = 0;
+    for (int i = 0; i < zipfKeys; i++)
+        cdf[i] = (sum += 1.0 / (i + 1));
+    for (int i = 0; i < zipfKeys; i++)
+        cdf[i] /= sum;
+    for (int i = 0; i < zipfKeys; i++)
+        t->insert(Container(keys[i], 1));
+
+    Timer timer;
+    int count = 0;
+    timer.update();
+    for (int i = 0; i < zipfNum; i++) {
+        double u = random(30) / double(1 << 30);
+        int rank = lower_bound(cdf.begin(), cdf.end(), u) - cdf.begin();
+        if (t->find(Container(keys[rank < zipfKeys ? rank : zipfKeys - 1], 0)))
+            count++;
+    }
+    cout << "zipf find: " << timer.update() << " (" << count << " hits)" << endl;
+}
+
+// Blind upserts into a tree whose cache is far smaller than the data, then point finds.
+void testIngest(BeTree<Container> *t) {
+    Timer timer;
+    timer.update();
+    for (int i = 0; i < ingestNum; i++)
+        t->upsert(Container(random(30), 1));
+    t->sync();
+    cout << "upsert: " << timer.update() << " (" << t->pagesRead() << " pages read, "
+        << t->pagesWritten() << " written)" << endl;
+    cout << "checkValid: " << t->checkValid() << endl;
+
+    unsigned long long reads = t->pagesRead();
+    int count = 0;
+    timer.update();
+    for (int i = 0; i < findNum; i++)
+        if (t->find(Container(random(30), 0)))
+            count++;
+    cout << "find: " << timer.update() << " (" << t->pagesRead() - reads
+        << " pages read, " << count << " hits)" << endl;
+}
+
+// Upserts keep a window of the newest keys and erase the rest; freed pages must be reused.
+void testWindow(BeTree<Container> *t) {
+    const int window = ingestNum / 10;
+    Timer timer;
+    timer.update();
+    size_t filled = 0;
+    for (int i = 0; i < ingestNum; i++) {
+        t->upsert(Container(i, 1));
+        if (i >= window)
+            t->erase(Container(i - window, 0));
+        if (i == 2 * window)
+            filled = t->pageCount();
+    }
+    t->sync();
+    cout << "window: " << timer.update() << " (" << filled << " pages after two windows, "
+        << t->pageCount() << " at the end, " << t->freePageCount() << " free)" << endl;
+    cout << "checkValid: " << t->checkValid() << endl;
+}
+
 int random(int bit) {
     static const int s = (1 << 15) - 1;
     if (bit < 16)
@@ -0,0 +1,364 @@
+#pragma once
+
+#include "FingerBT.h"
+#include "RotationCounter.h"
+#include "Augment.h"
+
+namespace sine {
+namespace tree {
+
+/**
+ * WAVL  AVL ƽ⣩
+ * ÿڵȣսڵΪ -1ӵȲΪ 1  2ҶӵΪ 0
+ * ֻвʱȲ AVL ƽһһӦ߲ AVL 
+ *  2,2 ڵʹɾʱתΣֻǸȡ
+ * A Ϊڵչ Augment.hR Ϊת RotationCounter.h
+ */
+template<class T, class A = NoAugment, class R = NoRotationCount>
+class WAVLTree : public FingerBT<T> {
+
+public:
+
+    using FingerBT<T>::insert;
+
+    virtual bool insert(const_ref);
+    virtual bool remove(const_ref);
+
+    virtual bool checkBalance() const;
+
+    typename A::value_type aggregate(const_ref lo, const_ref hi) const;  // [lo, hi] ڵľۺֵ
+
+    void compact();  // ѽڵ㰴 van Emde Boas ˳ᵽһڴУ֮Կ޸
+    MemoryStats memoryStats() const;
+
+    static unsigned long long rotationCount();  // ͬһ͵ۼƵתR Ϊ NoRotationCount ʱΪ 0
+    static void resetRotationCount();
+
+protected:
+
+    virtual Bnode_ptr insertSubtree(const_ref, Bnode_ptr_ref, int &sign);
+    virtual bool propagateInsert(Bnode_ptr_ref, int i, int &sign);
+    virtual void afterInsert();
+
+private:
+
+    class Node;
+    typedef Node * node_ptr;
+
+    class Node : public A::template Node<BinaryNode> {
+    public:
+        int rank;
+        Node();
+        Node(const_ref);
+        virtual Bnode_ptr clone();
+        bool live() const;
+    };
+
+    static int rank(Bnode_ptr);
+    static int &rankOf(Bnode_ptr);
+
+    static Bnode_ptr insertToTree(const_ref, Bnode_ptr_ref, int &sign);
+    static Bnode_ptr removeFromTree(const_ref, Bnode_ptr_ref);
+    static bool fixInsert(Bnode_ptr_ref, int);  // ӽڵ i ֮󣬷رǷ
+    static void fixRemove(Bnode_ptr_ref, int);  // ӽڵ i ȼٻɾ֮
+    static Bnode_ptr pickMaxAndFix(Bnode_ptr_ref);
+
+    static void rotate(Bnode_ptr_ref, bool right);
+    static void pull(Bnode_ptr);  // ¼ڵչ
+
+    static int testAndGetRank(node_ptr);
+
+    typedef typename R::template Counter<WAVLTree<T, A, R> > Rotations;
+
+};
+
+template<class T, class A, class R>
+bool WAVLTree<T, A, R>::insert(const_ref t) {
+    dropFinger();
+    if (root == NULL) {
+        root = new Node(t);
+        pull(root);
+        return true;
+    }
+    int unused = 0;
+    return insertToTree(t, root, unused) != NULL;
+}
+
+template<class T, class A, class R>
+bool WAVLTree<T, A, R>::remove(const_ref t) {
+    dropFinger();
+    if (root == NULL)
+        return false;
+    Bnode_ptr del = removeFromTree(t, root);
+    freeNode(del);
+    return del != NULL;
+}
+
+template<class T, class A, class R>
+bool WAVLTree<T, A, R>::checkBalance() const {
+    return testAndGetRank(static_cast<node_ptr>(root)) >= -1;
+}
+
+template<class T, class A, class R>
+typename A::value_type WAVLTree<T, A, R>::aggregate(const_ref lo, const_ref hi) const {
+    return A::query(static_cast<const Node *>(root), &lo, &hi);
+}
+
+template<class T, class A, class R>
+void WAVLTree<T, A, R>::compact() {
+    dropFinger();
+    compactAs<Node>();
+}
+
+template<class T, class A, class R>
+MemoryStats WAVLTree<T, A, R>::memoryStats() const {
+    return statsAs<Node>();
+}
+
+template<class T, class A, class R>
+unsigned long long WAVLTree<T, A, R>::rotationCount() {
+    return Rotations::count();
+}
+
+template<class T, class A, class R>
+void WAVLTree<T, A, R>::resetRotationCount() {
+    Rotations::reset();
+}
+
+template<class T, class A, class R>
+typename WAVLTree<T, A, R>::Bnode_ptr WAVLTree<T, A, R>::insertSubtree
+(const_ref t, Bnode_ptr_ref _r, int &sign) {
+    sign = 0;
+    return insertToTree(t, _r, sign);
+}
+
+template<class T, class A, class R>
+bool WAVLTree<T, A, R>::propagateInsert(Bnode_ptr_ref _r, int i, int &sign) {
+    sign = sign != 0 && fixInsert(_r, i) ? 1 : 0;
+    pull(_r);
+    return sign != 0 || A::enabled;  // չʱһֱµ
+}
+
+template<class T, class A, class R>
+void WAVLTree<T, A, R>::afterInsert() {
+}
+
+template<class T, class A, class R>
+WAVLTree<T, A, R>::Node::Node()
+    : rank(0) {
+}
+
+template<class T, class A, class R>
+WAVLTree<T, A, R>::Node::Node(const_ref v)
+    : A::template Node<BinaryNode>(v), rank(0) {
+}
+
+template<class T, class A, class R>
+typename WAVLTree<T, A, R>::Bnode_ptr WAVLTree<T, A, R>::Node::clone() {
+    node_ptr rtn = new Node(v);
+    rtn->rank = rank;
+    if (child[0] != NULL)
+        rtn->child[0] = child[0]->clone();
+    if (child[1] != NULL)
+        rtn->child[1] = child[1]->clone();
+    pull(rtn);
+    return rtn;
+}
+
+template<class T, class A, class R>
+bool WAVLTree<T, A, R>::Node::live() const {
+    return true;
+}
+
+template<class T, class A, class R>
+int WAVLTree<T, A, R>::rank(Bnode_ptr r) {
+    return r == NULL ? -1 : static_cast<node_ptr>(r)->rank;
+}
+
+template<class T, class A, class R>
+int &WAVLTree<T, A, R>::rankOf(Bnode_ptr r) {
+    return static_cast<node_ptr>(r)->rank;
+}
+
+/**
+ * ܿսڵ㡣sign Ϊ 1 ʾˡ
+ */
+template<class T, class A, class R>
+typename WAVLTree<T, A, R>::Bnode_ptr WAVLTree<T, A, R>::insertToTree
+(const_ref v, Bnode_ptr_ref _r, int &sign) {
+    if (v == _r->v)
+        return NULL;
+    int i = v < _r->v ? 0 : 1;
+    Bnode_ptr_ref _c = _r->child[i];
+    Bnode_ptr p;
+    int sign2 = 1;
+    if (_c == NULL) {
+        p = _c = new Node(v);
+        pull(_c);
+    }
+    else {
+        sign2 = 0;
+        p = insertToTree(v, _c, sign2);
+        if (p == NULL)
+            return NULL;
+    }
+    sign = sign2 != 0 && fixInsert(_r, i) ? 1 : 0;
+    pull(_r);
+    return p;
+}
+
+/**
+ * ӽڵ c Ϊ 0 ӽڵʱֵ 1 ӽڵ㲢ϣ
+ * תһλκ
+ */
+template<class T, class A, class R>
+bool WAVLTree<T, A, R>::fixInsert(Bnode_ptr_ref _r, int i) {
+    Bnode_ptr c = _r->child[i];
+    if (rank(_r) != rank(c))
+        return false;
+    if (rank(_r) - rank(_r->child[1 - i]) == 1) {
+        rankOf(_r)++;
+        return true;
+    }
+    Bnode_ptr p = _r, y = c->child[1 - i];
+    if (rank(c) - rank(y) == 2) {
+        rotate(_r, i == 0);
+        rankOf(p)--;
+    }
+    else {
+        rotate(_r->child[i], i == 1);
+        rotate(_r, i == 0);
+        rankOf(y)++;
+        rankOf(c)--;
+        rankOf(p)--;
+    }
+    return false;
+}
+
+/**
+* ܿսڵ
+*/
+template<class T, class A, class R>
+typename WAVLTree<T, A, R>::Bnode_ptr WAVLTree<T, A, R>::removeFromTree
+(const_ref v, Bnode_ptr_ref _r) {
+    Bnode_ptr rtn = _r;
+    if (v == _r->v) {  // ҵǰڵ㡣
+        if (_r->child[0] != NULL) {  // ȡֵ滻
+            _r = pickMaxAndFix(rtn->child[0]);
+            _r->child[0] = rtn->child[0];
+            _r->child[1] = rtn->child[1];
+            rankOf(_r) = rankOf(rtn);
+            fixRemove(_r, 0);
+        }
+        else {  // ҽڵ㣨УҶ
+            _r = _r->child[1];
+        }
+        pull(_r);
+        rtn->child[0] = NULL;
+        rtn->child[1] = NULL;
+        return rtn;
+    }
+    int i = v < _r->v ? 0 : 1;
+    Bnode_ptr_ref _c = _r->child[i];
+    if (_c == NULL)
+        return NULL;
+    rtn = removeFromTree(v, _c);
+    if (rtn == NULL)
+        return NULL;
+    fixRemove(_r, i);
+    pull(_r);
+    return rtn;
+}
+
+/**
+ * 2,2 Ҷӽȣӽڵ i Ϊ 3 ӽڵʱ
+ * ֵ 2 ӽڵ㣬ֵ 2,2 ڵ㣬ȣһ飩
+ * תһλκ
+ */
+template<class T, class A, class R>
+void WAVLTree<T, A, R>::fixRemove(Bnode_ptr_ref _r, int i) {
+    Bnode_ptr p = _r;
+    if (p->child[0] == NULL && p->child[1] == NULL) {
+        rankOf(p) = 0;
+        return;
+    }
+    if (rank(p) - rank(p->child[i]) < 3)
+        return;
+    Bnode_ptr s = p->child[1 - i];
+    if (rank(p) - rank(s) == 2) {
+        rankOf(p)--;
+        return;
+    }
+    Bnode_ptr t = s->child[1 - i], u = s->child[i];
+    if (rank(s) - rank(t) == 2 && rank(s) - rank(u) == 2) {
+        rankOf(p)--;
+        rankOf(s)--;
+    }
+    else if (rank(s) - rank(t) == 1) {
+        rotate(_r, i == 1);
+        rankOf(s)++;
+        rankOf(p)--;
+        if (p->child[0] == NULL && p->child[1] == NULL)
+            rankOf(p)--;
+    }
+    else {
+        rotate(p->child[1 - i], i == 0);
+        rotate(_r, i == 1);
+        rankOf(u) += 2;
+        rankOf(s)--;
+        rankOf(p) -= 2;
+    }
+}
+
+template<class T, class A, class R>
+typename WAVLTree<T, A, R>::Bnode_ptr WAVLTree<T, A, R>::pickMaxAndFix(Bnode_ptr_ref _r) {
+    Bnode_ptr rtn = _r;
+    if (_r->child[1] == NULL) {  // ҽڵ㣬Լֵ
+        _r = _r->child[0];
+        return rtn;
+    }
+    rtn = pickMaxAndFix(_r->child[1]);
+    fixRemove(_r, 1);
+    pull(_r);
+    return rtn;
+}
+
+template<class T, class A, class R>
+void WAVLTree<T, A, R>::rotate(Bnode_ptr_ref _r, bool right) {
+    int i = right ? 1 : 0;
+    Bnode_ptr _c = _r->child[1 - i];
+    _r->child[1 - i] = _c->child[i];
+    _c->child[i] = _r;
+    _r = _c;
+    pull(_c->child[i]);
+    pull(_c);
+    Rotations::add();
+}
+
+template<class T, class A, class R>
+void WAVLTree<T, A, R>::pull(Bnode_ptr r) {
+    if (r != NULL)
+        A::pull(static_cast<node_ptr>(r));
+}
+
+/**
+ * ȣƽʱ -2
+ */
+template<class T, class A, class R>
+int WAVLTree<T, A, R>::testAndGetRank(node_ptr r) {
+    if (r == NULL)
+        return -1;
+    int r0 = testAndGetRank(static_cast<node_ptr>(r->child[0]));
+    int r1 = testAndGetRank(static_cast<node_ptr>(r->child[1]));
+    if (r0 == -2 || r1 == -2)
+        return -2;
+    int d0 = r->rank - r0, d1 = r->rank - r1;
+    if (d0 < 1 || d0 > 2 || d1 < 1 || d1 > 2)
+        return -2;
+    if (r0 == -1 && r1 == -1 && r->rank != 0)
+        return -2;
+    return r->rank;
+}
+
+}
+}